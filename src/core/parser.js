@@ -3,14 +3,18 @@
  * 解析日志中的 RICHLOG 格式数据并重组
  */
 
+const MAX_UINT32 = 0xFFFFFFFF;
+
 class RichLogParser {
   constructor() {
     // 存储已识别但未完成的数据片段
     this.fragments = {};
     // 存储已完成重组的数据项
     this.completedItems = {};
+    // 等待被引用数据完成的去重引用，以被引用 UUID 为键
+    this.pendingReferences = {};
     // 正则表达式用于匹配 RICHLOG 格式
-    this.richlogRegex = /RICHLOG:([^,]+),([^,]+),(\d+),(\d+),([0-9a-fA-F]+)/;
+    this.richlogRegex = /RICHLOG:([^,]+),([^,]+),(\d+),(\d+),([0-9a-fA-F]+)/g;
   }
 
   /**
@@ -19,21 +23,32 @@ class RichLogParser {
    * @returns {object|null} - 如果是 RICHLOG 则返回解析结果，否则返回 null
    */
   parseLine(logLine) {
-    const match = this.richlogRegex.exec(logLine);
-    if (!match) return null;
+    const regex = this.richlogRegex;
+    regex.lastIndex = 0;
     
-    const [_, type, uuid, index, totalChunks, hexData] = match;
-    const indexNum = parseInt(index, 10);
-    const totalNum = parseInt(totalChunks, 10);
+    let match;
+    while ((match = regex.exec(logLine)) !== null) {
+      const [_, type, uuid, index, totalChunks, hexData] = match;
+      const indexNum = parseInt(index, 10);
+      const totalNum = parseInt(totalChunks, 10);
+      
+      // 与 C++ 解析器一致：index 或 total 超出 uint32 范围时该位置不算匹配，从下一个字符继续查找
+      if (indexNum > MAX_UINT32 || totalNum > MAX_UINT32) {
+        regex.lastIndex = match.index + 1;
+        continue;
+      }
+      
+      // 创建解析结果对象
+      return {
+        type,
+        uuid,
+        index: indexNum,
+        totalChunks: totalNum,
+        hexData
+      };
+    }
     
-    // 创建解析结果对象
-    return {
-      type,
-      uuid,
-      index: indexNum,
-      totalChunks: totalNum,
-      hexData
-    };
+    return null;
   }
 
   /**
@@ -47,6 +62,11 @@ class RichLogParser {
     
     const { type, uuid, index, totalChunks, hexData } = parsedData;
     
+    // 去重引用行：index 与 total 均为 0，数据部分为之前相同内容的 UUID
+    if (index === 0 && totalChunks === 0) {
+      return this.resolveReference(type, uuid, hexData.toLowerCase());
+    }
+    
     // 初始化该 UUID 的片段存储
     if (!this.fragments[uuid]) {
       this.fragments[uuid] = {
@@ -87,6 +107,11 @@ class RichLogParser {
         this.completedItems[uuid] = completeData;
         // 清除片段数据，释放内存
         delete this.fragments[uuid];
+        // 解析等待该数据的引用
+        (this.pendingReferences[uuid] || []).forEach(ref => {
+          this.resolveReference(ref.type, ref.uuid, uuid);
+        });
+        delete this.pendingReferences[uuid];
         return completeData;
       }
     }
@@ -94,6 +119,32 @@ class RichLogParser {
     return null;
   }
 
+  /**
+   * 解析去重引用
+   * @param {string} type - 引用行的数据类型
+   * @param {string} uuid - 引用行的 UUID
+   * @param {string} targetUuid - 被引用数据的 UUID
+   * @returns {object|null} - 被引用数据已完成时返回引用行对应的完整数据，否则返回 null
+   */
+  resolveReference(type, uuid, targetUuid) {
+    const target = this.completedItems[targetUuid];
+    if (!target) {
+      if (!this.pendingReferences[targetUuid]) {
+        this.pendingReferences[targetUuid] = [];
+      }
+      this.pendingReferences[targetUuid].push({ type, uuid });
+      return null;
+    }
+    
+    const item = {
+      type,
+      uuid,
+      hexData: target.hexData
+    };
+    this.completedItems[uuid] = item;
+    return item;
+  }
+
   /**
    * 重组特定 UUID 的全部片段
    * @param {string} uuid - 数据 UUID
@@ -31,38 +31,40 @@ class PluginHandler {
   }
   
   /**
-   * 将十六进制数据转换为适合插件的格式
+   * 将载荷数据转换为适合插件的格式
    * @param {string} type - 数据类型
-   * @param {string} hexData - 十六进制数据
+   * @param {string|Uint8Array} payload - 十六进制数据，或 Worker 解析得到的原始字节
    * @returns {Object} - 转换后的数据对象，如果插件不支持则返回错误对象
    */
-  convertDataForPlugin(type, hexData) {
+  convertDataForPlugin(type, payload) {
     // 首先检查插件是否存在，避免重复检查和警告
     const pluginInfo = this.pluginRegistry.getPluginInfo(type);
     if (!pluginInfo) {
       return { error: `不支持的数据类型: ${type}` };
     }
     
+    const bytes = typeof payload === 'string' ? this.hexToBytes(payload) : payload;
+    
     // 尝试调用特定类型的转换方法
     const converterMethodName = `convert${type.charAt(0).toUpperCase() + type.slice(1)}Data`;
     
     if (typeof this[converterMethodName] === 'function') {
       // 如果存在对应的转换方法，则调用它
-      return this[converterMethodName](hexData);
+      return this[converterMethodName](bytes);
     } else {
-      // 使用默认转换：将十六进制转换为字符串
+      // 使用默认转换：将字节转换为字符串
       // 这是通用的数据转换方法，适用于大部分简单文本数据
-      return { data: this.hexToString(hexData) };
+      return { data: this.bytesToString(bytes) };
     }
   }
   
   /**
-   * 将十六进制数据转换为配置对象
-   * @param {string} hexData - 十六进制数据
+   * 将原始字节转换为配置对象
+   * @param {Uint8Array} bytes - 原始字节
    * @returns {Object} - 配置数据对象
    */
-  convertConfigData(hexData) {
-    const jsonStr = this.hexToString(hexData);
+  convertConfigData(bytes) {
+    const jsonStr = this.bytesToString(bytes);
     try {
       const configObj = JSON.parse(jsonStr);
       return { data: configObj };
@@ -73,44 +75,88 @@ class PluginHandler {
   }
   
   /**
-   * 将十六进制数据转换为图片数据
-   * @param {string} hexData - 十六进制数据
+   * 将原始字节转换为图片数据
+   * @param {Uint8Array} bytes - 原始字节
    * @returns {Object} - 图片数据对象
    */
-  convertImageData(hexData) {
-    const base64Data = this.hexToBase64(hexData);
-    // 检测图片格式并设置适当的 MIME 类型
-    // 这里简单地假设是 JPEG，实际应用中可以检测文件头
-    const mimeType = 'image/jpeg';
+  convertImageData(bytes) {
+    const base64Data = this.bytesToBase64(bytes);
+    const mimeType = this.detectImageMimeType(bytes);
     return {
       data: `data:${mimeType};base64,${base64Data}`
     };
   }
   
   /**
-   * 将十六进制数据转换为命令输出
-   * @param {string} hexData - 十六进制数据
+   * 将原始字节转换为命令输出
+   * @param {Uint8Array} bytes - 原始字节
    * @returns {Object} - 命令输出对象
    */
-  convertCommandData(hexData) {
-    const text = this.hexToString(hexData);
+  convertCommandData(bytes) {
+    const text = this.bytesToString(bytes);
     return {
       data: text,
       lines: text.split('\n')
     };
   }
   
+  /**
+   * 根据文件头检测图片 MIME 类型
+   * @param {Uint8Array} bytes - 图片字节
+   * @returns {string} - MIME 类型，无法识别时返回 image/jpeg
+   */
+  detectImageMimeType(bytes) {
+    const startsWith = (...signature) => signature.every((value, i) => bytes[i] === value);
+    if (startsWith(0x89, 0x50, 0x4E, 0x47)) return 'image/png';
+    if (startsWith(0x47, 0x49, 0x46)) return 'image/gif';
+    if (startsWith(0x42, 0x4D)) return 'image/bmp';
+    if (startsWith(0x52, 0x49, 0x46, 0x46) && bytes[8] === 0x57 && bytes[9] === 0x45) return 'image/webp';
+    return 'image/jpeg';
+  }
+  
+  /**
+   * 将十六进制字符串转换为字节数组
+   * @param {string} hexString - 十六进制字符串
+   * @returns {Uint8Array} - 字节数组
+   */
+  hexToBytes(hexString) {
+    const bytes = new Uint8Array(hexString.length >> 1);
+    for (let i = 0; i < bytes.length; i++) {
+      bytes[i] = parseInt(hexString.substring(i * 2, i * 2 + 2), 16);
+    }
+    return bytes;
+  }
+  
+  /**
+   * 将字节数组按 Latin-1 转换为字符串
+   * @param {Uint8Array} bytes - 字节数组
+   * @returns {string} - 字符串
+   */
+  bytesToString(bytes) {
+    // 分块调用 fromCharCode，避免逐字节拼接和参数过多导致的栈溢出
+    const parts = [];
+    for (let i = 0; i < bytes.length; i += 0x8000) {
+      parts.push(String.fromCharCode.apply(null, bytes.subarray(i, i + 0x8000)));
+    }
+    return parts.join('');
+  }
+  
+  /**
+   * 将字节数组转换为 Base64
+   * @param {Uint8Array} bytes - 字节数组
+   * @returns {string} - Base64 编码的字符串
+   */
+  bytesToBase64(bytes) {
+    return btoa(this.bytesToString(bytes));
+  }
+  
   /**
    * 将十六进制字符串转换为字符串
    * @param {string} hexString - 十六进制字符串
    * @returns {string} - 解码后的字符串
    */
   hexToString(hexString) {
-    let result = '';
-    for (let i = 0; i < hexString.length; i += 2) {
-      result += String.fromCharCode(parseInt(hexString.substring(i, i + 2), 16));
-    }
-    return result;
+    return this.bytesToString(this.hexToBytes(hexString));
   }
   
   /**
@@ -119,34 +165,7 @@ class PluginHandler {
    * @returns {string} - Base64 编码的字符串
    */
   hexToBase64(hexString) {
-    // 创建一个字节数组
-    const bytes = new Uint8Array(hexString.length / 2);
-    for (let i = 0; i < hexString.length; i += 2) {
-      bytes[i/2] = parseInt(hexString.substring(i, i + 2), 16);
-    }
-    
-    // 现代浏览器中更高效的方式转换为 Base64
-    if (typeof TextDecoder !== 'undefined' && typeof btoa !== 'undefined') {
-      try {
-        return btoa(String.fromCharCode.apply(null, bytes));
-      } catch (e) {
-        // 如果数组过大，需要分块处理
-        let binary = '';
-        const len = bytes.byteLength;
-        for (let i = 0; i < len; i++) {
-          binary += String.fromCharCode(bytes[i]);
-        }
-        return btoa(binary);
-      }
-    } else {
-      // 兼容旧浏览器
-      let binary = '';
-      const len = bytes.byteLength;
-      for (let i = 0; i < len; i++) {
-        binary += String.fromCharCode(bytes[i]);
-      }
-      return btoa(binary);
-    }
+    return this.bytesToBase64(this.hexToBytes(hexString));
   }
   
   /**
@@ -21,6 +21,7 @@ let logLines = [];
 let filteredLines = [];
 let richLogEntries = {};
 let searchTerm = '';
+let loaderWorker = null;
 
 // DOM 元素
 let logContainer;
@@ -170,6 +171,13 @@ function handleFileInput(event) {
   const file = event.target.files[0];
   if (!file) return;
   
+  // 支持 Worker 和 Blob.stream() 时在后台流式解析
+  if (typeof Worker !== 'undefined' && typeof file.stream === 'function') {
+    loadLogFileInWorker(file);
+    event.target.value = '';
+    return;
+  }
+  
   const reader = new FileReader();
   reader.onload = e => {
     parseLogContent(e.target.result);
@@ -180,6 +188,43 @@ function handleFileInput(event) {
   event.target.value = '';
 }
 
+// 在 Worker 中流式解析日志文件
+function loadLogFileInWorker(file) {
+  if (loaderWorker) {
+    loaderWorker.terminate();
+  }
+  
+  // 清除现有数据
+  logLines = [];
+  richLogEntries = {};
+  parser = new RichLogParser();
+  
+  loaderWorker = new Worker(new URL('./log-loader.worker.js', import.meta.url));
+  loaderWorker.onmessage = event => {
+    const message = event.data;
+    if (message.type === 'batch') {
+      for (const line of message.lines) {
+        logLines.push(line);
+      }
+      message.items.forEach(item => {
+        richLogEntries[item.uuid] = item;
+      });
+    } else if (message.type === 'done') {
+      loaderWorker.terminate();
+      loaderWorker = null;
+      updateStats();
+      applyFilters();
+    } else if (message.type === 'error') {
+      loaderWorker.terminate();
+      loaderWorker = null;
+      showToast('error', '日志加载失败', message.message);
+    } else if (message.type === 'start') {
+      console.log(`日志解析引擎: ${message.engine}`);
+    }
+  };
+  loaderWorker.postMessage({ file });
+}
+
 // 解析日志内容
 function parseLogContent(content) {
   // 清除现有数据
@@ -302,7 +347,8 @@ function openRichLogData(type, uuid) {
   }
   
   // 转换数据格式
-  const data = pluginHandler.convertDataForPlugin(type, entry.hexData);
+  // Worker 解析的数据项携带原始字节，粘贴解析的数据项携带十六进制
+  const data = pluginHandler.convertDataForPlugin(type, entry.bytes || entry.hexData);
   
   // 检查数据转换是否成功
   if (data && data.error) {
@@ -410,6 +456,12 @@ function clearSearch() {
 
 // 清除日志
 function clearLog() {
+  // 停止正在进行的后台加载
+  if (loaderWorker) {
+    loaderWorker.terminate();
+    loaderWorker = null;
+  }
+  
   logLines = [];
   filteredLines = [];
   richLogEntries = {};
@@ -0,0 +1,62 @@
+/**
+ * 日志加载 Worker
+ * 通过 Blob.stream() 分块读取日志文件并解析，避免大文件阻塞页面
+ */
+
+const { LogStreamProcessor } = require('./log-stream');
+
+// WASM 解析器由 npm run build:wasm 生成并复制到 dist/wasm/，不存在时使用 JS 解析器
+const WASM_SCRIPT = 'wasm/richlog_wasm.js';
+
+let wasmModulePromise = null;
+
+function loadWasmModule() {
+  if (!wasmModulePromise) {
+    wasmModulePromise = new Promise(resolve => {
+      try {
+        importScripts(WASM_SCRIPT);
+        createRichLogModule({ locateFile: path => `wasm/${path}` })
+          .then(resolve, () => resolve(null));
+      } catch (error) {
+        resolve(null);
+      }
+    });
+  }
+  return wasmModulePromise;
+}
+
+function postBatch(result, loaded, total) {
+  // 转移字节数据的所有权，避免复制
+  self.postMessage(
+    { type: 'batch', lines: result.lines, items: result.items, loaded, total },
+    result.items.map(item => item.bytes.buffer)
+  );
+}
+
+self.onmessage = async event => {
+  const { file } = event.data;
+  let processor = null;
+
+  try {
+    const wasmModule = await loadWasmModule();
+    processor = new LogStreamProcessor(wasmModule);
+    self.postMessage({ type: 'start', engine: wasmModule ? 'wasm' : 'js' });
+
+    const reader = file.stream().getReader();
+    let loaded = 0;
+    while (true) {
+      const { done, value } = await reader.read();
+      if (done) break;
+      loaded += value.length;
+      postBatch(processor.push(value), loaded, file.size);
+    }
+    postBatch(processor.finish(), loaded, file.size);
+    self.postMessage({ type: 'done' });
+  } catch (error) {
+    self.postMessage({ type: 'error', message: error.message });
+  } finally {
+    if (processor) {
+      processor.dispose();
+    }
+  }
+};
@@ -0,0 +1,145 @@
+/**
+ * 日志流处理器
+ * 逐块处理日志文件内容，输出用于显示的日志行和重组完成的富媒体数据。
+ * 优先使用 WebAssembly 版本的 C++ 解析器，不可用时退回到 JS 解析器。
+ */
+
+const RichLogParser = require('../core/parser');
+
+// 十六进制字符到数值的查找表
+const HEX_VALUES = (() => {
+  const table = new Int8Array(128).fill(-1);
+  for (let i = 0; i < 10; i++) table[48 + i] = i;
+  for (let i = 0; i < 6; i++) {
+    table[65 + i] = 10 + i;
+    table[97 + i] = 10 + i;
+  }
+  return table;
+})();
+
+/**
+ * 将十六进制字符串转换为字节数组
+ * @param {string} hexString - 十六进制字符串
+ * @returns {Uint8Array} - 字节数组
+ */
+function hexToBytes(hexString) {
+  const bytes = new Uint8Array(hexString.length >> 1);
+  for (let i = 0, j = 0; i < bytes.length; i++, j += 2) {
+    bytes[i] = (HEX_VALUES[hexString.charCodeAt(j)] << 4) | HEX_VALUES[hexString.charCodeAt(j + 1)];
+  }
+  return bytes;
+}
+
+class LogStreamProcessor {
+  /**
+   * @param {Object|null} wasmModule - createRichLogModule() 得到的模块，为 null 时使用 JS 解析器
+   */
+  constructor(wasmModule = null) {
+    this.wasm = wasmModule;
+    this.stream = wasmModule ? wasmModule._richlog_stream_create() : 0;
+    // JS 模式下负责重组；WASM 模式下只用来读取完成行的片段总数
+    this.parser = new RichLogParser();
+    this.textDecoder = new TextDecoder();
+    this.partialLine = '';
+    this.lineNumber = 0;
+  }
+
+  /**
+   * 处理一块原始数据
+   * @param {Uint8Array} chunk - 文件数据块，可以在任意位置切分
+   * @returns {{lines: string[], items: Array}} - 新的显示行和完成的数据项
+   */
+  push(chunk) {
+    if (this.wasm) {
+      const ptr = this.wasm._richlog_stream_buffer(this.stream, chunk.length);
+      this.wasm.HEAPU8.set(chunk, ptr);
+      this.wasm._richlog_stream_feed(this.stream, chunk.length);
+    }
+
+    const text = this.partialLine + this.textDecoder.decode(chunk, { stream: true });
+    const lines = text.split('\n');
+    this.partialLine = lines.pop();
+    return this.processLines(lines);
+  }
+
+  /**
+   * 输入结束，处理最后一行
+   * @returns {{lines: string[], items: Array}} - 新的显示行和完成的数据项
+   */
+  finish() {
+    if (this.wasm) {
+      this.wasm._richlog_stream_finish(this.stream);
+    }
+
+    const text = this.partialLine + this.textDecoder.decode();
+    this.partialLine = '';
+    return this.processLines(text ? [text] : []);
+  }
+
+  /**
+   * 释放 WASM 端的解析器
+   */
+  dispose() {
+    if (this.wasm && this.stream) {
+      this.wasm._richlog_stream_destroy(this.stream);
+      this.stream = 0;
+    }
+  }
+
+  processLines(rawLines) {
+    const firstLine = this.lineNumber;
+    this.lineNumber += rawLines.length;
+
+    // WASM 模式：按完成行号收集本批完成的数据项
+    const completedByLine = new Map();
+    if (this.wasm) {
+      const count = this.wasm._richlog_stream_poll(this.stream);
+      for (let i = 0; i < count; i++) {
+        const ptr = this.wasm._richlog_payload_data(this.stream, i);
+        const size = this.wasm._richlog_payload_size(this.stream, i);
+        const item = {
+          type: this.wasm.UTF8ToString(this.wasm._richlog_payload_type(this.stream, i)),
+          uuid: this.wasm.UTF8ToString(this.wasm._richlog_payload_uuid(this.stream, i)),
+          // slice 复制出独立的 ArrayBuffer，便于转移给主线程
+          bytes: this.wasm.HEAPU8.slice(ptr, ptr + size)
+        };
+        const line = this.wasm._richlog_payload_line(this.stream, i);
+        if (!completedByLine.has(line)) completedByLine.set(line, []);
+        completedByLine.get(line).push(item);
+      }
+    }
+
+    const lines = [];
+    const items = [];
+    rawLines.forEach((rawLine, i) => {
+      const line = rawLine.endsWith('\r') ? rawLine.slice(0, -1) : rawLine;
+      if (line.trim()) {
+        lines.push(line);
+      }
+
+      let completed;
+      if (this.wasm) {
+        completed = completedByLine.get(firstLine + i) || [];
+      } else {
+        const item = this.parser.addLogLine(line);
+        completed = item ? [{ type: item.type, uuid: item.uuid, bytes: hexToBytes(item.hexData) }] : [];
+      }
+
+      completed.forEach(item => {
+        items.push(item);
+        // 在完成行之后添加引用行，与主线程的解析方式一致
+        const parsedData = this.parser.parseLine(line);
+        const totalChunks = parsedData ? parsedData.totalChunks : 0;
+        const referenceText = `[${item.type}] (共 ${totalChunks} 个片段)`;
+        lines.push(line.replace(/RICHLOG:.+/, referenceText));
+      });
+    });
+
+    return { lines, items };
+  }
+}
+
+module.exports = {
+  LogStreamProcessor,
+  hexToBytes
+};
@@ -0,0 +1,199 @@
+#include "richlog.hpp"
+#include "scanner.hpp"
+#include "stream_parser.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace richlog;
+
+namespace {
+
+// 与 generate_log 相同格式的时间戳前缀，长度固定
+const std::string kPrefix = "[2023-08-15 10:00:01.236] ";
+
+struct Payload {
+    std::string type;
+    std::vector<uint8_t> data;
+};
+
+struct BenchResult {
+    std::string mode;
+    size_t lines = 0;
+    size_t longestLine = 0;
+    size_t bytes = 0;
+    double seconds = 0;
+};
+
+void printUsage() {
+    std::cerr << "用法: chunk_bench [选项]\n"
+              << "\n"
+              << "用相同的载荷分别以固定分片大小和单行长度上限编码，报告日志体积、行数和 StreamParser 吞吐量。\n"
+              << "\n"
+              << "选项:\n"
+              << "  --payloads <数量>   载荷数量，默认 300\n"
+              << "  --seed <种子>       随机种子，默认 1\n";
+}
+
+// 文本类载荷由重复的键值行组成，图片为随机字节
+std::vector<Payload> generatePayloads(size_t count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<Payload> payloads;
+    payloads.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        Payload payload;
+        uint32_t kind = rng() % 10;
+        if (kind < 5) {
+            payload.type = "config";
+            size_t size = 1024 + rng() % 3072;
+            std::string text;
+            while (text.size() < size) {
+                text += "\"key" + std::to_string(rng() % 1000) + "\": " + std::to_string(rng()) + ",\n";
+            }
+            payload.data.assign(text.begin(), text.begin() + static_cast<std::ptrdiff_t>(size));
+        } else if (kind < 8) {
+            payload.type = "command";
+            size_t size = 2048 + rng() % 14336;
+            std::string text;
+            while (text.size() < size) {
+                text += "drwxr-xr-x 2 user group " + std::to_string(rng() % 100000) + " file.txt\n";
+            }
+            payload.data.assign(text.begin(), text.begin() + static_cast<std::ptrdiff_t>(size));
+        } else {
+            payload.type = "image";
+            payload.data.resize(16384 + rng() % 245760);
+            for (auto& byte : payload.data) {
+                byte = static_cast<uint8_t>(rng());
+            }
+        }
+        payloads.push_back(std::move(payload));
+    }
+    return payloads;
+}
+
+// 编码所有载荷并拼接为日志文本，两条载荷之间插入一行普通日志
+std::string encodeLog(RichLogEncoder& encoder, const std::vector<Payload>& payloads, size_t chunkSize,
+                      BenchResult& result) {
+    std::string log;
+    for (const auto& payload : payloads) {
+        for (const auto& block : encoder.encode(payload.type, payload.data, chunkSize)) {
+            size_t start = log.size();
+            log += kPrefix;
+            log += "RICHLOG:";
+            log += block.type;
+            log += ',';
+            log += block.uuid;
+            log += ',';
+            log += std::to_string(block.index);
+            log += ',';
+            log += std::to_string(block.total);
+            log += ',';
+            appendHex(log, block.data.data(), block.data.size());
+            result.longestLine = std::max(result.longestLine, log.size() - start);
+            log += '\n';
+            ++result.lines;
+        }
+        log += kPrefix;
+        log += "INFO: User login successful\n";
+        ++result.lines;
+    }
+    result.bytes = log.size();
+    return log;
+}
+
+// 取三次运行的最短耗时
+double timeParse(const std::string& log, size_t expectedPayloads) {
+    double best = 0;
+    for (int run = 0; run < 3; ++run) {
+        auto start = std::chrono::steady_clock::now();
+        StreamParser parser;
+        parser.feed(log.data(), log.size());
+        parser.finish();
+        size_t completed = parser.takeCompleted().size();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (completed != expectedPayloads) {
+            std::cerr << "❌ 重组结果不完整: " << completed << " / " << expectedPayloads << std::endl;
+            std::exit(2);
+        }
+        best = run == 0 ? seconds : std::min(best, seconds);
+    }
+    return best;
+}
+
+void printResults(const std::vector<BenchResult>& results, size_t payloadBytes) {
+    double payloadMegabytes = static_cast<double>(payloadBytes) / (1024.0 * 1024.0);
+    std::cout << "📊 载荷总量: " << std::fixed << std::setprecision(2) << payloadMegabytes << " MB\n\n";
+    // 表头含中文，setw 按字节计算宽度，直接写出对齐后的文本
+    std::cout << "模式                 行数    最长行     日志(MB)    膨胀率    日志 MB/s   载荷 MB/s\n";
+    for (const auto& result : results) {
+        double seconds = std::max(result.seconds, 1e-9);
+        double megabytes = static_cast<double>(result.bytes) / (1024.0 * 1024.0);
+        std::cout << std::left << std::setw(16) << result.mode << std::right << std::setw(10) << result.lines
+                  << std::setw(10) << result.longestLine << std::setw(13) << std::setprecision(2) << megabytes
+                  << std::setw(9) << static_cast<double>(result.bytes) / static_cast<double>(payloadBytes)
+                  << "x" << std::setw(12) << std::setprecision(1) << megabytes / seconds << std::setw(12)
+                  << payloadMegabytes / seconds << "\n";
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t payloadCount = 300;
+    uint32_t seed = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "--payloads" || arg == "--seed") && i + 1 < argc) {
+            std::string value = argv[++i];
+            if (arg == "--payloads") {
+                payloadCount = static_cast<size_t>(std::strtoull(value.c_str(), nullptr, 10));
+            } else {
+                seed = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+            }
+        } else if (arg == "-h" || arg == "--help") {
+            printUsage();
+            return 0;
+        } else {
+            std::cerr << "❌ 未知参数: " << arg << std::endl;
+            return 2;
+        }
+    }
+
+    auto payloads = generatePayloads(payloadCount, seed);
+    size_t payloadBytes = 0;
+    for (const auto& payload : payloads) {
+        payloadBytes += payload.data.size();
+    }
+
+    std::vector<BenchResult> results;
+    for (size_t chunkSize : {64, 128, 256, 512, 1024, 2048, 4096, 8192, 16384}) {
+        RichLogEncoder encoder;
+        BenchResult result;
+        result.mode = "chunk=" + std::to_string(chunkSize);
+        std::string log = encodeLog(encoder, payloads, chunkSize, result);
+        result.seconds = timeParse(log, payloads.size());
+        results.push_back(result);
+    }
+    for (size_t maxLine : {512, 1024, 2048, 4096, 8192, 16384}) {
+        RichLogEncoder encoder;
+        encoder.setMaxLineLength(maxLine, kPrefix.size());
+        BenchResult result;
+        result.mode = "line<=" + std::to_string(maxLine);
+        std::string log = encodeLog(encoder, payloads, 1024, result);
+        if (result.longestLine > maxLine) {
+            std::cerr << "❌ 行长度超过上限: " << result.longestLine << " > " << maxLine << std::endl;
+            return 2;
+        }
+        result.seconds = timeParse(log, payloads.size());
+        results.push_back(result);
+    }
+
+    printResults(results, payloadBytes);
+    return 0;
+}
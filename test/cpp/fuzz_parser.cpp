@@ -0,0 +1,66 @@
+#include "parser_harness.hpp"
+#include "scanner.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#ifdef RICHLOG_FUZZ_REPLAY
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#endif
+
+using namespace richlog;
+
+namespace {
+
+// std::regex 按字符递归匹配，过长的输入会耗尽参考实现的栈
+constexpr size_t kMaxInputSize = 4096;
+
+} // namespace
+
+// 所有解析器实现对同一输入的结果必须一致，出现差异时打印各实现结果并中止
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size > kMaxInputSize) {
+        return 0;
+    }
+    static ParserDiffHarness harness;
+    std::string line(reinterpret_cast<const char*>(data), size);
+
+    std::vector<std::string> results;
+    if (!harness.compare(line, &results)) {
+        for (size_t i = 0; i < results.size(); ++i) {
+            std::fprintf(stderr, "%s: %s\n", harness.implementations()[i].name.c_str(), results[i].c_str());
+        }
+        std::abort();
+    }
+
+    // 行视图与完整解析的结果一致
+    RichLogLineView scalar;
+    RichLogLineView simd;
+    bool scalarMatched = scanRichLogLine(line, scalar);
+    if (scalarMatched != scanRichLogLineSimd(line, simd) ||
+        (scalarMatched && (scalar.type != simd.type || scalar.uuid != simd.uuid || scalar.hex != simd.hex))) {
+        std::abort();
+    }
+    return 0;
+}
+
+#ifdef RICHLOG_FUZZ_REPLAY
+// 没有 libFuzzer 时逐个重放命令行给出的语料文件
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        std::ifstream file(argv[i], std::ios::binary);
+        if (!file) {
+            std::cerr << "❌ 无法打开文件: " << argv[i] << std::endl;
+            return 2;
+        }
+        std::string input((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t*>(input.data()), input.size());
+    }
+    std::cout << "✅ 已重放 " << (argc - 1) << " 个输入" << std::endl;
+    return 0;
+}
+#endif
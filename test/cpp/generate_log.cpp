@@ -1,4 +1,6 @@
 #include "richlog.hpp"
+#include "image_transcoder.hpp"
+#include "thread_pool.hpp"
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -7,6 +9,7 @@
 #include <random>
 #include <vector>
 #include <string>
+#include <cstdlib>
 
 using namespace richlog;
 
@@ -14,10 +17,21 @@ class LogGenerator {
 private:
     RichLogEncoder encoder;
     std::mt19937 rng;
+    bool transcodeImages = false;
     
 public:
     LogGenerator() : rng(std::random_device{}()) {}
     
+    // 开启后图片数据先转码为 PNG 再分片
+    void setImageTranscoding(bool enabled) {
+        transcodeImages = enabled;
+    }
+    
+    // 按单行长度上限自动计算分片大小，前缀为时间戳加一个空格
+    void setMaxLineLength(size_t maxLineLength) {
+        encoder.setMaxLineLength(maxLineLength, generateTimestamp().size() + 1);
+    }
+    
     // 生成时间戳
     std::string generateTimestamp() {
         auto now = std::chrono::system_clock::now();
@@ -202,7 +216,11 @@ Total: 367001600 blocks used, 285521232 blocks available)";
     std::string generateRichLogLine(const std::string& type, 
                                    const std::vector<uint8_t>& data,
                                    size_t maxChunkSize = 1024) {
-        auto blocks = encoder.encode(type, data, maxChunkSize);
+        return formatBlocks(encoder.encode(type, data, maxChunkSize));
+    }
+    
+    // 将数据块格式化为日志行
+    std::string formatBlocks(const std::vector<RichLogBlock>& blocks) {
         std::stringstream ss;
         
         for (const auto& block : blocks) {
@@ -251,7 +269,13 @@ Total: 367001600 blocks used, 285521232 blocks available)";
         // 添加图片数据
         std::cout << "🖼️  生成图片数据..." << std::endl;
         auto imageData = generateImageData();
-        file << generateRichLogLine("image", imageData, 512); // 较小的分块大小
+        if (transcodeImages) {
+            ThreadPool pool(1);
+            ImageTranscodeStage stage(encoder, pool);
+            file << formatBlocks(stage.encode("image", imageData, 512).get());
+        } else {
+            file << generateRichLogLine("image", imageData, 512); // 较小的分块大小
+        }
         
         // 添加更多普通日志
         for (int i = 0; i < numEntries / 6; ++i) {
@@ -279,18 +303,36 @@ Total: 367001600 blocks used, 285521232 blocks available)";
     }
 };
 
-int main() {
+int main(int argc, char* argv[]) {
     std::cout << "🚀 RichLog C++ 日志生成器" << std::endl;
     std::cout << "=========================" << std::endl;
     
     std::string filename = "test_richlog.log";
     int numEntries = 50;
+    bool transcodeImages = false;
+    size_t maxLineLength = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--png") {
+            transcodeImages = true;
+        } else if (arg == "--max-line" && i + 1 < argc) {
+            maxLineLength = static_cast<size_t>(std::strtoull(argv[++i], nullptr, 10));
+        }
+    }
     
     std::cout << "📁 输出文件: " << filename << std::endl;
     std::cout << "📊 日志条目数: " << numEntries << std::endl;
+    std::cout << "🖼️  图片转码: " << (transcodeImages ? "PNG" : "关闭") << std::endl;
+    if (maxLineLength > 0) {
+        std::cout << "📏 单行上限: " << maxLineLength << " 字节" << std::endl;
+    }
     std::cout << std::endl;
     
     LogGenerator generator;
+    generator.setImageTranscoding(transcodeImages);
+    if (maxLineLength > 0) {
+        generator.setMaxLineLength(maxLineLength);
+    }
     generator.generateLogFile(filename, numEntries);
     
     std::cout << std::endl;
@@ -298,6 +340,7 @@ int main() {
     std::cout << "   cat " << filename << std::endl;
     std::cout << "   tail -f " << filename << std::endl;
     std::cout << "   grep RICHLOG " << filename << std::endl;
+    std::cout << "   ./build/richlog_cli search --richlog " << filename << std::endl;
     
     return 0;
 }
@@ -0,0 +1,115 @@
+#ifndef RICHLOG_BLOCK_TABLE_HPP
+#define RICHLOG_BLOCK_TABLE_HPP
+
+#include "richlog.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace richlog {
+
+struct RichLogLineView;
+
+/**
+ * @brief 紧凑的数据块记录，固定 32 字节，一个缓存行放两条
+ *
+ * 类型和 uuid 换成驻留编号，载荷放在 BlockTable 的连续缓冲区中，
+ * 校验、分组只访问这些记录，不会触及载荷。
+ */
+struct BlockRecord {
+    uint64_t uuid = 0;      // 驻留后的 uuid 编号
+    uint32_t typeId = 0;    // 驻留后的类型编号
+    uint32_t index = 0;     // 当前分片索引
+    uint32_t total = 0;     // 总分片数量
+    uint32_t length = 0;    // 载荷字节数
+    uint64_t offset = 0;    // 载荷在 BlockTable 缓冲区中的偏移
+};
+
+static_assert(sizeof(BlockRecord) == 32, "BlockRecord 应为 32 字节");
+
+/**
+ * @brief BlockTable 中同一 uuid 的连续记录
+ */
+struct BlockRange {
+    uint64_t uuid = 0;
+    size_t begin = 0;
+    size_t count = 0;
+};
+
+/**
+ * @brief 以紧凑记录保存大量数据块
+ *
+ * 记录（热数据）与载荷（冷数据）分开存放：记录数组连续排列，
+ * 载荷依次追加到同一块缓冲区，不再为每个数据块单独分配内存。
+ */
+class BlockTable {
+public:
+    /**
+     * @brief 预留空间
+     * @param blocks 数据块数量
+     * @param payloadBytes 载荷总字节数
+     */
+    void reserve(size_t blocks, size_t payloadBytes);
+
+    /**
+     * @brief 追加数据块，返回记录位置
+     * @throw std::length_error 单个载荷超过 4 GiB
+     */
+    size_t append(const RichLogBlock& block);
+
+    /**
+     * @brief 追加扫描得到的行视图，十六进制直接解码到载荷缓冲区
+     * @param view scanRichLogLine 的结果
+     * @return 十六进制是否合法，不合法时不追加
+     */
+    bool append(const RichLogLineView& view);
+
+    uint32_t internType(std::string_view type);
+    uint64_t internUuid(std::string_view uuid);
+
+    const std::vector<BlockRecord>& records() const { return records_; }
+    size_t size() const { return records_.size(); }
+    bool empty() const { return records_.empty(); }
+
+    const std::string& type(uint32_t typeId) const { return types_[typeId]; }
+    const std::string& uuid(uint64_t uuidId) const { return uuids_[uuidId]; }
+
+    /**
+     * @brief 记录对应的载荷，指针在下一次追加之前有效
+     */
+    const uint8_t* payload(const BlockRecord& record) const { return payload_.data() + record.offset; }
+
+    /**
+     * @brief 还原为 RichLogBlock（拷贝载荷）
+     */
+    RichLogBlock toBlock(const BlockRecord& record) const;
+
+    /**
+     * @brief 按 uuid 分组，记录原地重排
+     *
+     * uuid 编号是连续的，使用计数排序，两次顺序扫描完成。组按 uuid 首次出现的顺序排列，
+     * 组内保持追加顺序，因此重复分片中先到的一份仍在前面。
+     * @return 每个 uuid 的记录区间
+     */
+    std::vector<BlockRange> groupByUuid();
+
+    void clear();
+
+private:
+    size_t appendRecord(std::string_view type, std::string_view uuid, uint32_t index, uint32_t total,
+                        size_t length);
+
+    std::vector<BlockRecord> records_;
+    std::vector<uint8_t> payload_;
+    std::vector<std::string> types_;
+    std::vector<std::string> uuids_;
+    std::unordered_map<std::string, uint32_t> typeIds_;
+    std::unordered_map<std::string, uint64_t> uuidIds_;
+};
+
+} // namespace richlog
+
+#endif // RICHLOG_BLOCK_TABLE_HPP
@@ -0,0 +1,95 @@
+#ifndef RICHLOG_IMAGE_TRANSCODER_HPP
+#define RICHLOG_IMAGE_TRANSCODER_HPP
+
+#include "richlog.hpp"
+#include "thread_pool.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <string>
+#include <vector>
+
+namespace richlog {
+
+/**
+ * @brief 接收编码输出的回调，数据只在调用期间有效
+ */
+using ByteSink = std::function<void(const uint8_t* data, size_t size)>;
+
+/**
+ * @brief 未压缩的原始图像帧
+ */
+struct RawImage {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t channels = 3;          // 3 = RGB，4 = RGBA
+    std::vector<uint8_t> pixels;    // 自上而下逐行存放，行间无填充
+};
+
+/**
+ * @brief 判断数据是否为可转码的 BMP（未压缩的 24/32 位 BI_RGB）
+ */
+bool isBmpImage(const std::vector<uint8_t>& data);
+
+/**
+ * @brief 将 BMP 无损转码为 PNG
+ *
+ * 逐行滤波并用内置的 deflate 压缩，输出按 IDAT 块依次交给 sink，
+ * 不会在内存中拼出完整的 PNG 文件。
+ * @param bmp BMP 文件数据
+ * @param sink 输出回调
+ * @return 不是可转码的 BMP 时返回 false，此时 sink 不会被调用
+ */
+bool transcodeBmpToPng(const std::vector<uint8_t>& bmp, const ByteSink& sink);
+
+/**
+ * @brief 将原始图像帧编码为 PNG
+ * @param image 原始图像帧
+ * @param sink 输出回调
+ * @return 尺寸或通道数无效时返回 false
+ */
+bool encodePng(const RawImage& image, const ByteSink& sink);
+
+/**
+ * @brief 图片转码阶段，位于 RichLogEncoder::encode 之前（可选启用）
+ *
+ * BMP 和原始图像帧在线程池中转码为 PNG，编码输出直接写入分片；
+ * 由于每个分片都要携带总片数，分片列表在转码结束后一次性返回。
+ * 转码结果不小于原始数据时退回到原始数据分片。其他数据原样交给 encoder，
+ * 在调用线程中完成，因此 encoder 不需要线程安全。
+ */
+class ImageTranscodeStage {
+public:
+    ImageTranscodeStage(RichLogEncoder& encoder, ThreadPool& pool);
+
+    /**
+     * @brief 编码载荷，BMP 图片先转码为 PNG
+     * @param type 数据类型
+     * @param data 原始数据
+     * @param maxChunkSize 最大分片大小，encoder 设置了行长度上限时忽略，否则必须大于 0
+     * @return 数据块列表的 future
+     */
+    std::future<std::vector<RichLogBlock>> encode(const std::string& type,
+                                                  std::vector<uint8_t> data,
+                                                  size_t maxChunkSize = 1024);
+
+    /**
+     * @brief 将原始图像帧编码为 PNG 数据块
+     * @param type 数据类型
+     * @param frame 原始图像帧
+     * @param maxChunkSize 最大分片大小，encoder 设置了行长度上限时忽略，否则必须大于 0
+     * @return 数据块列表的 future，帧无效时抛出 std::invalid_argument
+     */
+    std::future<std::vector<RichLogBlock>> encodeFrame(const std::string& type,
+                                                       RawImage frame,
+                                                       size_t maxChunkSize = 1024);
+
+private:
+    RichLogEncoder& encoder_;
+    ThreadPool& pool_;
+};
+
+} // namespace richlog
+
+#endif // RICHLOG_IMAGE_TRANSCODER_HPP
@@ -0,0 +1,116 @@
+#ifndef RICHLOG_LOG_SEARCH_HPP
+#define RICHLOG_LOG_SEARCH_HPP
+
+#include "thread_pool.hpp"
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace richlog {
+
+/**
+ * @brief 只读映射的日志文件
+ *
+ * POSIX 平台使用 mmap，其他平台退回到整体读入内存。
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief 打开并映射文件，之前打开的文件会先关闭
+     * @param path 文件路径
+     * @return 是否成功
+     */
+    bool open(const std::string& path);
+
+    void close();
+
+    /**
+     * @brief 文件内容，在 close() 或析构之前有效
+     */
+    std::string_view view() const { return std::string_view(data_, size_); }
+
+    size_t size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::vector<char> buffer_;  // 未使用 mmap 时的文件内容
+};
+
+/**
+ * @brief 搜索条件，各条件同时满足时行才匹配
+ */
+struct SearchQuery {
+    std::vector<std::string> literals;  // 行内包含其中任意一个即可，为空表示不限
+    std::string type;                   // 只匹配该类型的 RICHLOG 行
+    std::string uuid;                   // 只匹配该 uuid 的 RICHLOG 行
+    bool richlogOnly = false;           // 只匹配 RICHLOG 行
+};
+
+/**
+ * @brief 匹配的日志行
+ */
+struct SearchMatch {
+    size_t offset = 0;          // 行首在文本中的字节偏移
+    size_t lineNumber = 0;      // 行号，从 1 开始
+    std::string_view line;      // 行内容（不含换行符），指向被搜索的文本
+};
+
+/**
+ * @brief 按内容、RICHLOG 类型和 uuid 一次过滤日志行
+ *
+ * 文本按换行边界切成若干区间并行搜索。每个区间内先用 SIMD 子串查找定位最有区分度的
+ * 字面量（搜索文本、uuid 或 "RICHLOG:type,"），只对命中的行做完整校验，
+ * 不需要逐行扫描。多个搜索文本各自记录下一个命中位置，整段文本每个字面量只扫描一遍。
+ */
+class LogSearcher {
+public:
+    static constexpr size_t kDefaultRangeSize = 4 << 20;
+
+    /**
+     * @param query 搜索条件，搜索文本不能包含换行符
+     * @throw std::invalid_argument 搜索文本包含换行符
+     */
+    explicit LogSearcher(SearchQuery query);
+
+    /**
+     * @brief 判断单行是否匹配
+     */
+    bool matchesLine(std::string_view line) const;
+
+    /**
+     * @brief 并行搜索文本，结果按行号排序
+     * @param pool 线程池
+     * @param text 日志文本
+     * @param rangeSize 每个并行区间的大致字节数
+     * @return 匹配的行
+     */
+    std::vector<SearchMatch> search(ThreadPool& pool, std::string_view text,
+                                    size_t rangeSize = kDefaultRangeSize) const;
+
+private:
+    struct RangeResult {
+        std::vector<SearchMatch> matches;   // lineNumber 为区间内的行序号（从 0 开始）
+        size_t newlineCount = 0;
+    };
+
+    bool matchesRichLog(std::string_view line) const;
+    void searchRange(std::string_view text, size_t begin, size_t end, RangeResult& result) const;
+
+    SearchQuery query_;
+    std::vector<std::string> anchors_;  // 用于定位候选行的字面量，为空时逐行检查
+    bool literalAnchors_ = false;       // 定位字面量即搜索文本
+    bool matchAll_ = false;             // 没有任何条件
+};
+
+} // namespace richlog
+
+#endif // RICHLOG_LOG_SEARCH_HPP
@@ -0,0 +1,112 @@
+#ifndef RICHLOG_LOG_STATS_HPP
+#define RICHLOG_LOG_STATS_HPP
+
+#include "thread_pool.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace richlog {
+
+/**
+ * @brief 按 2 的幂分桶的直方图，第 k 个桶统计 [2^(k-1), 2^k) 的值，第 0 个桶统计 0
+ */
+struct PowerOfTwoHistogram {
+    std::array<uint64_t, 65> buckets{};
+
+    void add(uint64_t value);
+    void merge(const PowerOfTwoHistogram& other);
+};
+
+/**
+ * @brief 不完整或无效载荷的样本，便于定位到日志中的具体位置
+ */
+struct PayloadSample {
+    std::string uuid;
+    uint64_t offset = 0;     // 第一个分片所在行的字节偏移
+    uint32_t received = 0;   // 收到的不同分片数
+    uint32_t total = 0;      // 第一个分片声明的总分片数
+    bool invalid = false;    // true 表示分片头部矛盾，否则为缺少分片
+};
+
+/**
+ * @brief 一种类型（或全部类型合计）的载荷统计
+ *
+ * 载荷按 uuid 区分，去重引用行单独计数，不算作载荷。
+ * 字节数由十六进制长度推算，不解码数据。
+ */
+struct TypeStats {
+    uint64_t payloads = 0;            // 不同 uuid 的数量
+    uint64_t completePayloads = 0;    // 收齐全部分片
+    uint64_t incompletePayloads = 0;  // 缺少分片
+    uint64_t invalidPayloads = 0;     // 分片头部矛盾：索引越界，或同一 uuid 的类型、总数不一致
+    uint64_t references = 0;          // 去重引用行
+    uint64_t chunks = 0;              // RICHLOG 行数，含重复分片和引用行
+    uint64_t duplicateChunks = 0;     // 同一 uuid 重复出现的分片
+    uint64_t payloadBytes = 0;        // 不同分片的载荷字节数之和
+    uint64_t encodedBytes = 0;        // RICHLOG 行的字节数（不含换行符）
+    uint64_t maxPayloadBytes = 0;     // 完整载荷的最大字节数
+    PowerOfTwoHistogram payloadSizes;       // 完整载荷的字节数分布
+    PowerOfTwoHistogram chunksPerPayload;   // 完整载荷的分片数分布
+    std::vector<PayloadSample> samples;     // 偏移最小的若干个不完整或无效载荷
+
+    void merge(const TypeStats& other, size_t sampleLimit);
+};
+
+/**
+ * @brief 一个日志文件的统计结果
+ */
+struct LogStats {
+    uint64_t bytes = 0;                       // 日志字节数
+    uint64_t richlogLines = 0;                // 可以解析的 RICHLOG 行
+    uint64_t invalidLines = 0;                // 含 "RICHLOG:" 但无法解析的行
+    TypeStats total;                          // 全部类型合计
+    std::map<std::string, TypeStats> types;   // 按类型统计
+};
+
+/**
+ * @brief 只读取 RICHLOG 头部和十六进制长度的单遍统计
+ *
+ * 第一阶段把文本按换行边界切成区间并行扫描，用 findRichLogMarker 跳到 RICHLOG 行，
+ * 只读取类型、uuid、索引、总数和十六进制长度，当场汇总为区间内每个 uuid 的状态
+ * （收到分片的位图和字节数）和按类型的行计数；第二阶段按 uuid 哈希分片，并行地
+ * 按区间顺序合并同一 uuid 的状态。内存与载荷数成正比，与行数无关；载荷数据不解码、不拷贝。
+ */
+class LogStatsCollector {
+public:
+    static constexpr size_t kDefaultRangeSize = 4 << 20;
+    static constexpr size_t kDefaultSampleLimit = 5;
+
+    /**
+     * @param sampleLimit 每种类型保留的不完整或无效载荷样本数
+     */
+    explicit LogStatsCollector(size_t sampleLimit = kDefaultSampleLimit);
+
+    /**
+     * @brief 并行统计文本中的 RICHLOG 载荷
+     * @param pool 线程池
+     * @param text 日志文本，统计期间必须保持有效
+     * @param rangeSize 每个并行区间的大致字节数
+     * @return 统计结果
+     */
+    LogStats collect(ThreadPool& pool, std::string_view text, size_t rangeSize = kDefaultRangeSize) const;
+
+private:
+    size_t sampleLimit_;
+};
+
+/**
+ * @brief 将统计结果格式化为 JSON 对象
+ * @param stats 统计结果
+ * @param path 日志文件路径，写入 "path" 字段
+ * @return 带缩进的 JSON 文本，不含末尾换行
+ */
+std::string formatLogStatsJson(const LogStats& stats, const std::string& path);
+
+} // namespace richlog
+
+#endif // RICHLOG_LOG_STATS_HPP
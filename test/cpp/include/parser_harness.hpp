@@ -0,0 +1,105 @@
+#ifndef RICHLOG_PARSER_HARNESS_HPP
+#define RICHLOG_PARSER_HARNESS_HPP
+
+#include "richlog.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace richlog {
+
+/**
+ * @brief 参与差分比较的解析器实现
+ */
+struct ParserImplementation {
+    std::string name;
+    std::unique_ptr<Parser> parser;
+};
+
+/**
+ * @brief 全部 C++ 解析器：reference（正则）、fast（标量扫描）、simd（SSE2 / WebAssembly SIMD 扫描）
+ *
+ * 第一个为参考实现，其余实现的结果都应与它完全相同。
+ */
+std::vector<ParserImplementation> makeParserImplementations();
+
+/**
+ * @brief 解析结果的规范化描述，单行 JSON，不匹配时为 null
+ *
+ * 字段依次为 type、uuid、index、total、data（小写十六进制）。0x20 以下和 0x7f 以上的字节
+ * 转义为 \u00XX，与 JS 以 latin1 读取同一文件得到的字符串一致，供 test/js/parser-parity.js 对比。
+ */
+std::string describeParseResult(const RichLogBlock* block);
+
+/**
+ * @brief 各实现结果不一致的输入行
+ */
+struct ParserDivergence {
+    size_t line = 0;                    // 行序号，从 0 开始
+    std::string input;
+    std::vector<std::string> results;   // 与实现顺序对应的 describeParseResult
+};
+
+/**
+ * @brief 单个实现解析全部输入的耗时
+ */
+struct ParserThroughput {
+    std::string name;
+    double seconds = 0;
+    size_t matched = 0;     // 解析出数据块的行数
+};
+
+/**
+ * @brief 差分运行结果
+ */
+struct ParserDiffReport {
+    size_t lines = 0;
+    size_t bytes = 0;
+    std::vector<ParserThroughput> throughput;
+    std::vector<ParserDivergence> divergences;
+    size_t divergenceCount = 0;         // divergences 最多保留前若干条，这里是总数
+};
+
+/**
+ * @brief 在相同输入上运行所有解析器实现并比较结果
+ */
+class ParserDiffHarness {
+public:
+    ParserDiffHarness();
+
+    /**
+     * @brief 比较单行
+     * @param line 日志行
+     * @param results 不为空时输出各实现的 describeParseResult
+     * @return 所有实现结果一致
+     */
+    bool compare(const std::string& line, std::vector<std::string>* results = nullptr);
+
+    /**
+     * @brief 每个实现单独计时解析全部输入，再逐行比较
+     * @param lines 输入行
+     * @param maxDivergences 报告中最多保留的差异条数
+     */
+    ParserDiffReport run(const std::vector<std::string>& lines, size_t maxDivergences = 100);
+
+    const std::vector<ParserImplementation>& implementations() const { return implementations_; }
+
+private:
+    std::vector<ParserImplementation> implementations_;
+};
+
+/**
+ * @brief 生成差分测试语料
+ *
+ * 包含正常 RICHLOG 行、普通日志行，以及对它们做随机替换、插入标记、截断、
+ * 越界数字等变异后的行。行内不含换行符。
+ * @param count 行数
+ * @param seed 随机种子，相同种子生成相同语料
+ */
+std::vector<std::string> generateParserCorpus(size_t count, uint32_t seed);
+
+} // namespace richlog
+
+#endif // RICHLOG_PARSER_HARNESS_HPP
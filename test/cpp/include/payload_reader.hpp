@@ -0,0 +1,83 @@
+#ifndef RICHLOG_PAYLOAD_READER_HPP
+#define RICHLOG_PAYLOAD_READER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace richlog {
+
+/**
+ * @brief 按需解码的载荷读取器
+ *
+ * 只保存各分片的十六进制文本，读取时才解码。RichLogEncoder::encode 产生的分片
+ * 除最后一片外大小一致，因此字节偏移可以直接换算成分片索引，读取开销只与请求的
+ * 字节数有关。分片大小不一致时退化为按分片长度累加定位，仍然不需要解码无关分片。
+ * 去重引用行作为被引用载荷的别名，读取时转到被引用的载荷。
+ */
+class PayloadReader {
+public:
+    /**
+     * @brief 添加日志行
+     * @param logLine 日志行
+     * @return 是否为被接受的 RichLog 分片
+     */
+    bool addLine(std::string_view logLine);
+
+    /**
+     * @brief 读取载荷的一段字节
+     *
+     * 从 offset 开始连续读取，遇到载荷末尾或尚未收到的分片时提前结束。
+     * @param uuid 载荷 uuid
+     * @param offset 起始字节偏移
+     * @param length 最多读取的字节数
+     * @return 读取到的字节，uuid 不存在时为空
+     */
+    std::vector<uint8_t> read(const std::string& uuid, uint64_t offset, size_t length) const;
+
+    /**
+     * @brief 获取载荷总字节数，需要已收到最后一个分片且大小可确定
+     * @param uuid 载荷 uuid
+     * @param size 输出总字节数
+     * @return 是否可确定
+     */
+    bool payloadSize(const std::string& uuid, uint64_t& size) const;
+
+    /**
+     * @brief 载荷是否已收齐所有分片
+     */
+    bool isComplete(const std::string& uuid) const;
+
+    /**
+     * @brief 获取载荷类型，uuid 不存在时返回空字符串
+     */
+    std::string typeOf(const std::string& uuid) const;
+
+private:
+    struct Payload {
+        std::string type;
+        uint32_t total = 0;
+        std::map<uint32_t, std::string> hexChunks;  // 索引 -> 十六进制文本
+        size_t uniformChunkSize = 0;                 // 非末尾分片的字节数，0 表示未知
+        bool uniform = true;                         // 非末尾分片大小是否一致
+    };
+
+    struct Reference {
+        std::string type;
+        std::string target;
+    };
+
+    const Payload* findPayload(const std::string& uuid) const;
+    bool chunkStart(const Payload& payload, uint32_t index, uint64_t& start) const;
+
+    std::unordered_map<std::string, Payload> payloads_;
+    std::unordered_map<std::string, Reference> references_;  // 引用 uuid -> 被引用载荷
+};
+
+} // namespace richlog
+
+#endif // RICHLOG_PAYLOAD_READER_HPP
@@ -0,0 +1,255 @@
+#ifndef RICHLOG_REASSEMBLER_HPP
+#define RICHLOG_REASSEMBLER_HPP
+
+#include "richlog.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace richlog {
+
+class ThreadPool;
+struct RichLogLineView;
+
+/**
+ * @brief 重组完成的载荷
+ */
+struct ReassembledPayload {
+    std::string type;           // 数据类型
+    std::string uuid;           // 唯一标识符
+    std::vector<uint8_t> data;  // 按索引拼接后的数据
+    uint64_t sequence = 0;      // 完成序号：各分片序号中的最大值
+};
+
+/**
+ * @brief 重组器配置
+ */
+struct ReassemblerOptions {
+    size_t shardCount = 16;          // 分片数量，按 uuid 哈希分配
+    bool deterministicOrder = false; // 按完成序号输出，与单线程顺序扫描的结果一致
+    size_t referenceCacheSize = 256; // 为解析去重引用而保留的最近载荷数（不小于 kMinDedupSize 字节），0 表示不保留
+    size_t finishedCacheSize = 16384; // 记住的已完成或丢弃的 uuid 数（含引用块），之后到达的分片计为重复
+    DuplicatePolicy duplicatePolicy = DuplicatePolicy::FirstWins; // 重复分片的处理方式
+};
+
+/**
+ * @brief 重组统计
+ */
+struct ReassemblerStats {
+    uint64_t duplicateChunks = 0;    // 收到的重复分片数，含载荷完成或丢弃后才到达的分片
+    uint64_t conflictingChunks = 0;  // 内容与第一份不一致的重复分片数（仅 VerifyChecksum）
+    uint64_t droppedPayloads = 0;    // 因重复分片内容冲突而丢弃的载荷数
+    uint64_t unresolvedReferences = 0; // 被引用载荷已完成或丢弃、但不在缓存中而无法解析的引用数
+    uint64_t abandonedPayloads = 0;    // 调用 abandon 放弃的载荷和引用数
+};
+
+/**
+ * @brief 按 uuid 哈希分片的并发重组器
+ *
+ * 每个 uuid 只落在一个分片中，不同分片之间没有共享状态，多个扫描线程可以同时
+ * 写入。同一 uuid 的分片可以来自文件的不同区间，按 index 归位后拼接。
+ *
+ * 序号（sequence）由调用方提供，通常为行号或文件偏移。开启 deterministicOrder
+ * 后重复分片保留序号最小的一份，takeCompleted 按完成序号排序；在所有生产者
+ * 结束后取结果时，输出与单线程顺序扫描一致。
+ *
+ * 例外是跨越载荷完成时刻的重复副本：载荷完成后到达的分片一律作为重复丢弃，
+ * 即使它的序号比已采用的那份更小。因此同一 uuid 的多份副本乱序提交、且序号
+ * 较大的副本先凑齐时，保留的数据和完成序号可能与顺序扫描不同。已完成的 uuid
+ * 超出 finishedCacheSize 后再到达的副本会开启新的载荷。
+ *
+ * 每个 uuid 按到达顺序收集分片，索引在位图中登记，重复分片只查位图即可丢弃，
+ * 不会保存多份副本。VerifyChecksum 模式下每个分片保存一个 64 位校验和，
+ * 重复分片与第一份不一致时整个载荷作废。
+ */
+class ShardedReassembler {
+public:
+    explicit ShardedReassembler(const ReassemblerOptions& options = ReassemblerOptions());
+
+    /**
+     * @brief 添加一个数据块（线程安全）
+     *
+     * 去重引用块会解析为被引用载荷的数据；被引用载荷尚未完成时引用会等待，
+     * 因此引用行与原始载荷可以由不同线程以任意顺序提交。被引用载荷已完成
+     * 但已移出最近载荷缓存（或已丢弃）时无法解析，计入 unresolvedReferences 并返回 false。
+     * @param block 数据块
+     * @param sequence 数据块在输入中的序号
+     * @return 是否被接受；类型或总数与已有分片不一致、索引越界时返回 false，
+     *         uuid 已完成或已丢弃（仍在 finishedCacheSize 范围内）时计为重复分片并返回 false
+     */
+    bool add(RichLogBlock block, uint64_t sequence = 0);
+
+    /**
+     * @brief 直接添加扫描得到的行视图（线程安全）
+     *
+     * 十六进制数据在确认需要时才解码：FirstWins 模式下重复分片完全不解码。
+     * @param view scanRichLogLine 的结果
+     * @param sequence 数据块在输入中的序号
+     * @return 同 add(RichLogBlock, uint64_t)
+     */
+    bool add(const RichLogLineView& view, uint64_t sequence = 0);
+
+    /**
+     * @brief 批量添加数据块，每个分片只加锁一次（线程安全）
+     * @param blocks 数据块及其序号
+     */
+    void addBatch(std::vector<std::pair<RichLogBlock, uint64_t>> blocks);
+
+    /**
+     * @brief 使用线程池并行解析日志行并重组
+     * @param pool 线程池
+     * @param lines 日志行，序号为 firstSequence + 行下标
+     * @param firstSequence 第一行的序号
+     */
+    void addLines(ThreadPool& pool, const std::vector<std::string>& lines, uint64_t firstSequence = 0);
+
+    /**
+     * @brief 取出目前所有已完成的载荷
+     * @return 已完成的载荷；deterministicOrder 时按完成序号排序
+     */
+    std::vector<ReassembledPayload> takeCompleted();
+
+    /**
+     * @brief 取出自上次调用以来作废的 uuid（线程安全）
+     *
+     * 包括因重复分片冲突而丢弃的载荷，以及被引用载荷丢弃后放弃等待的引用。
+     * 这些 uuid 不会再出现在 takeCompleted 中，调用方可以释放为其保留的状态。
+     */
+    std::vector<std::string> takeDropped();
+
+    /**
+     * @brief 放弃一个尚未完成的载荷或等待中的引用（线程安全）
+     *
+     * 用于清理长期收不齐的载荷。uuid 登记为已结束，之后到达的分片计为重复分片；
+     * 等待该载荷的引用随之放弃，由 takeDropped 报告。
+     * @param uuid 载荷或引用块的 uuid
+     * @param target 引用块指向的 uuid，普通载荷为空
+     * @return uuid 是否仍未完成并被放弃
+     */
+    bool abandon(const std::string& uuid, const std::string& target = std::string());
+
+    /**
+     * @brief 已完成或丢弃的 uuid（线程安全），每个分片内最近使用的在前
+     *
+     * 按相反顺序逐个调用 markFinished 可以在相同配置的重组器上恢复同样的淘汰顺序。
+     */
+    std::vector<std::string> finishedUuids() const;
+
+    /**
+     * @brief 将 uuid 登记为已结束（线程安全），用于从检查点恢复
+     *
+     * 已登记的 uuid 移到最近使用位置；之后到达的同一 uuid 的分片计为重复分片。
+     */
+    void markFinished(const std::string& uuid);
+
+    /**
+     * @brief 尚未收齐分片的 uuid 数量（含等待被引用载荷的引用）
+     */
+    size_t pendingCount() const;
+
+    size_t shardCount() const { return shards_.size(); }
+
+    /**
+     * @brief 重复分片统计
+     */
+    ReassemblerStats stats() const;
+
+    /**
+     * @brief uuid 所属的分片编号
+     */
+    size_t shardOf(std::string_view uuid) const;
+
+private:
+    // 索引不超过该值的分片放在按索引寻址的数组中，更大的（异常）索引放在 map 中，
+    // 避免单行异常的 total 导致巨大的分配
+    static constexpr uint32_t kDenseChunkLimit = 1 << 16;
+
+    struct Chunk {
+        std::vector<uint8_t> data;
+        uint64_t sequence = 0;
+        uint64_t checksum = 0;      // 仅 VerifyChecksum 模式计算
+    };
+
+    struct PendingPayload {
+        std::string type;
+        uint32_t total = 0;
+        uint32_t received = 0;
+        bool conflicted = false;
+        std::vector<uint64_t> present;   // 已收到索引的位图
+        std::vector<Chunk> dense;        // dense[index - 1]
+        std::map<uint32_t, Chunk> sparse;
+    };
+
+    struct ChunkSource;
+
+    // 按缓存行对齐，避免相邻分片的锁产生伪共享
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, PendingPayload> pending;
+        std::vector<ReassembledPayload> completed;
+        std::list<std::string> finished;   // 已完成或丢弃的 uuid，最近使用的在前
+        std::unordered_map<std::string, std::list<std::string>::iterator> finishedIndex;
+    };
+
+    struct RecentPayload {
+        std::string uuid;
+        std::shared_ptr<const std::vector<uint8_t>> data;
+        uint64_t sequence;
+    };
+
+    struct WaitingReference {
+        std::string type;
+        std::string uuid;
+        uint64_t sequence;
+    };
+
+    bool addLocked(Shard& shard, std::string_view type, const std::string& uuid, uint32_t index,
+                   uint32_t total, ChunkSource& source, uint64_t sequence);
+    bool addViewLocked(Shard& shard, const RichLogLineView& view, uint64_t sequence);
+    static Chunk* findChunk(PendingPayload& payload, uint32_t index);
+    static Chunk& insertChunk(PendingPayload& payload, uint32_t index);
+    bool touchFinished(Shard& shard, const std::string& uuid);
+    void rememberFinished(Shard& shard, const std::string& uuid);
+    bool addReference(const RichLogBlock& block, uint64_t sequence);
+    bool isFinished(const std::string& uuid);
+    bool cancelWaiting(const std::string& target, const std::string& uuid);
+    void abandonWaiting(const std::string& target);
+    void reportDropped(const std::string& uuid);
+    void rememberCompleted(const ReassembledPayload& payload);
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    bool deterministicOrder_;
+    DuplicatePolicy duplicatePolicy_;
+    size_t finishedPerShard_;
+    std::atomic<uint64_t> duplicateChunks_{0};
+    std::atomic<uint64_t> conflictingChunks_{0};
+    std::atomic<uint64_t> droppedPayloads_{0};
+    std::atomic<uint64_t> unresolvedReferences_{0};
+    std::atomic<uint64_t> abandonedPayloads_{0};
+
+    // 去重引用状态：载荷完成的频率远低于分片写入，单独一把锁即可
+    mutable std::mutex referenceMutex_;
+    size_t referenceCacheSize_;
+    std::list<RecentPayload> recentPayloads_;  // 最近使用的在前
+    std::unordered_map<std::string, std::list<RecentPayload>::iterator> recentIndex_;
+    std::unordered_map<std::string, std::vector<WaitingReference>> waitingReferences_;
+    std::atomic<size_t> waitingCount_{0};     // waitingReferences_ 中的引用总数，完成载荷时无锁判断
+    std::vector<ReassembledPayload> resolvedReferences_;
+
+    // 作废的 uuid，计数用于 takeDropped 无锁判断是否为空
+    std::mutex droppedMutex_;
+    std::vector<std::string> dropped_;
+    std::atomic<size_t> droppedCount_{0};
+};
+
+} // namespace richlog
+
+#endif // RICHLOG_REASSEMBLER_HPP
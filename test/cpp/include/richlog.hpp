@@ -4,10 +4,17 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
 
 namespace richlog {
 
+class BlockTable;
+struct BlockRange;
+
 /**
  * @brief RichLog 数据块结构
  */
@@ -23,6 +30,37 @@ struct RichLogBlock {
         : type(t), uuid(u), index(i), total(tot) {}
 };
 
+/**
+ * @brief 重复分片的处理方式
+ *
+ * at-least-once 的日志采集可能把同一行投递多次，同一 uuid 的同一索引会出现多份。
+ */
+enum class DuplicatePolicy {
+    Reject,         // 视为无效输入
+    FirstWins,      // 保留最先到达的一份，其余丢弃
+    VerifyChecksum  // 保留最先到达的一份，内容不一致时视为损坏
+};
+
+/**
+ * @brief 判断数据块是否为去重引用块
+ *
+ * 引用块的 index 与 total 均为 0，data 的十六进制即被引用载荷的 uuid，
+ * 对应日志行形如 RICHLOG:config,1a2b3c4d,0,0,5f35c0af。
+ */
+bool isReferenceBlock(const RichLogBlock& block);
+
+/**
+ * @brief 获取引用块指向的载荷 uuid
+ */
+std::string referencedUuid(const RichLogBlock& block);
+
+/**
+ * @brief 参与去重的最小载荷字节数
+ *
+ * 更小的载荷编码后并不比引用行长：写入端不为其生成引用，读取端也不缓存。
+ */
+constexpr size_t kMinDedupSize = 16;
+
 /**
  * @brief RichLog 解析器接口
  */
@@ -111,12 +149,110 @@ public:
         size_t maxChunkSize = 1024
     ) override;
     std::string generateUUID() override;
+
+    /**
+     * @brief 设置内容去重
+     *
+     * 开启后对载荷计算哈希，与最近 cacheSize 个载荷内容相同时只输出一个引用块。
+     * 缓存保存载荷副本，哈希相同时逐字节比较，内存占用约为 cacheSize 个载荷。
+     * 缓存按最近使用淘汰，读取端的引用缓存不应小于该值。
+     * @param cacheSize 哈希缓存容量，0 表示关闭
+     */
+    void setDeduplication(size_t cacheSize);
+
+    /**
+     * @brief 设置单行长度上限，开启后 encode 忽略 maxChunkSize，按上限计算分片大小
+     *
+     * 行长度按 前缀 + "RICHLOG:type,uuid,index,total," + 十六进制载荷 计算，不含换行符。
+     * 上限连一个字节的载荷都容纳不下时 encode 抛出 std::invalid_argument。
+     * @param maxLineLength 单行最大字节数，0 表示关闭
+     * @param prefixLength 日志框架在 RICHLOG: 之前写入的字节数（时间戳、级别和分隔空格等）
+     */
+    void setMaxLineLength(size_t maxLineLength, size_t prefixLength = 0);
+
+    /**
+     * @brief 当前设置下的分片大小
+     *
+     * 设置了行长度上限时按上限计算，否则返回 maxChunkSize。dataSize 可以取载荷大小的上界，
+     * 此时分片数被高估，最多多预留一位索引数字。上限过小，或未设置上限而 maxChunkSize 为 0 时
+     * 抛出 std::invalid_argument。
+     */
+    size_t chunkSizeFor(const std::string& type, size_t uuidLength, size_t dataSize, size_t maxChunkSize) const;
+
+    /**
+     * @brief 计算行长度不超过 maxLineLength 时的最大分片大小
+     *
+     * 每字节载荷编码为 2 个十六进制字符；索引和总数的位数取决于分片数，迭代到位数稳定为止。
+     * 行格式中没有校验字段，不需要额外预留。
+     * @param maxLineLength 单行最大字节数，不含换行符
+     * @param prefixLength RICHLOG: 之前的字节数
+     * @param type 数据类型
+     * @param uuidLength uuid 长度
+     * @param dataSize 载荷字节数
+     * @return 分片字节数，上限不足以容纳一个字节的载荷时为 0
+     */
+    static size_t chunkSizeForLineLength(size_t maxLineLength, size_t prefixLength,
+                                         const std::string& type, size_t uuidLength, size_t dataSize);
+
+private:
+    struct DedupEntry {
+        uint64_t hash;
+        std::vector<uint8_t> data;  // 载荷副本，哈希相同时用于逐字节比较
+        std::string uuid;
+    };
+
+    size_t dedupCapacity_ = 0;
+    size_t maxLineLength_ = 0;
+    size_t linePrefixLength_ = 0;
+    std::list<DedupEntry> dedupEntries_;  // 最近使用的在前
+    std::unordered_map<uint64_t, std::list<DedupEntry>::iterator> dedupIndex_;
 };
 
 class RichLogDecoder : public Decoder {
 public:
+    /**
+     * @brief 按 uuid 查找已解码载荷，找不到时返回 nullptr
+     */
+    using PayloadLookup = std::function<const std::vector<uint8_t>*(const std::string& uuid)>;
+
     std::vector<uint8_t> decode(const std::vector<RichLogBlock>& blocks) override;
     bool validateBlocks(const std::vector<RichLogBlock>& blocks) override;
+
+    /**
+     * @brief 设置 decode 对重复分片的处理方式，默认为 Reject
+     *
+     * 非 Reject 时按到达顺序为每个索引保留第一份分片，不需要排序；
+     * validateBlocks 始终按严格规则校验。
+     */
+    void setDuplicatePolicy(DuplicatePolicy policy) { duplicatePolicy_ = policy; }
+
+    /**
+     * @brief 解码数据块，引用块通过 lookup 解析为被引用载荷的数据
+     * @param blocks 数据块列表
+     * @param lookup 已解码载荷的查找函数
+     * @return 解码后的原始数据，引用无法解析时为空
+     */
+    std::vector<uint8_t> decode(const std::vector<RichLogBlock>& blocks, const PayloadLookup& lookup);
+
+    /**
+     * @brief 校验 BlockTable 中的一组记录，规则与 validateBlocks(blocks) 相同
+     *
+     * 只读取 32 字节的记录，不访问载荷；索引已按顺序排列时只需一次顺序扫描。
+     * @param table 数据块表
+     * @param range 记录区间，通常来自 BlockTable::groupByUuid()
+     */
+    bool validateBlocks(const BlockTable& table, const BlockRange& range) const;
+
+    /**
+     * @brief 解码 BlockTable 中的一组记录，重复分片按 setDuplicatePolicy() 处理
+     * @return 解码后的原始数据，记录不完整时为空
+     */
+    std::vector<uint8_t> decode(const BlockTable& table, const BlockRange& range) const;
+
+private:
+    std::vector<uint8_t> decodeTolerant(const std::vector<RichLogBlock>& blocks) const;
+
+    DuplicatePolicy duplicatePolicy_ = DuplicatePolicy::Reject;
 };
 
 } // namespace richlog
@@ -0,0 +1,53 @@
+#ifndef RICHLOG_WASM_H
+#define RICHLOG_WASM_H
+
+/**
+ * RichLog 流式解析的 C 接口，供 WebAssembly 构建导出给 Web Worker 使用。
+ *
+ * 典型调用顺序：
+ *   stream = richlog_stream_create();
+ *   循环：buffer = richlog_stream_buffer(stream, n); 写入 n 字节; richlog_stream_feed(stream, n);
+ *         count = richlog_stream_poll(stream); 逐个读取 richlog_payload_*;
+ *   richlog_stream_finish(stream); 再 poll 一次;
+ *   richlog_stream_destroy(stream);
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__EMSCRIPTEN__)
+#include <emscripten/emscripten.h>
+#define RICHLOG_EXPORT EMSCRIPTEN_KEEPALIVE
+#else
+#define RICHLOG_EXPORT
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct richlog_stream richlog_stream;
+
+RICHLOG_EXPORT richlog_stream* richlog_stream_create(void);
+RICHLOG_EXPORT void richlog_stream_destroy(richlog_stream* stream);
+
+/* 返回至少 size 字节的输入缓冲区，写入后调用 richlog_stream_feed */
+RICHLOG_EXPORT uint8_t* richlog_stream_buffer(richlog_stream* stream, size_t size);
+RICHLOG_EXPORT void richlog_stream_feed(richlog_stream* stream, size_t size);
+RICHLOG_EXPORT void richlog_stream_finish(richlog_stream* stream);
+
+/* 取出新完成的载荷，返回数量；上一次 poll 的结果随之失效 */
+RICHLOG_EXPORT size_t richlog_stream_poll(richlog_stream* stream);
+
+RICHLOG_EXPORT const char* richlog_payload_type(richlog_stream* stream, size_t index);
+RICHLOG_EXPORT const char* richlog_payload_uuid(richlog_stream* stream, size_t index);
+RICHLOG_EXPORT const uint8_t* richlog_payload_data(richlog_stream* stream, size_t index);
+RICHLOG_EXPORT size_t richlog_payload_size(richlog_stream* stream, size_t index);
+/* 完成该载荷的行号（从 0 开始） */
+RICHLOG_EXPORT double richlog_payload_line(richlog_stream* stream, size_t index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RICHLOG_WASM_H */
@@ -0,0 +1,89 @@
+#ifndef RICHLOG_SCANNER_HPP
+#define RICHLOG_SCANNER_HPP
+
+#include "richlog.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace richlog {
+
+/**
+ * @brief 不拷贝数据的 RichLog 行视图，各字段指向原始日志行
+ */
+struct RichLogLineView {
+    std::string_view type;   // 数据类型
+    std::string_view uuid;   // 唯一标识符
+    uint32_t index = 0;      // 当前分片索引
+    uint32_t total = 0;      // 总分片数量
+    std::string_view hex;    // 十六进制数据（未解码）
+};
+
+/**
+ * @brief 扫描日志行中的 RichLog 头部，不解码数据
+ *
+ * 匹配规则与 RichLogParser 的正则 RICHLOG:([^,]+),([^,]+),(\d+),(\d+),([0-9a-fA-F]+)
+ * 一致：取第一个能完整匹配的 "RICHLOG:" 位置。index 或 total 超出 uint32 范围时视为不匹配。
+ * @param line 日志行
+ * @param view 输出的行视图，仅在返回 true 时有效
+ * @return 是否匹配
+ */
+bool scanRichLogLine(std::string_view line, RichLogLineView& view);
+
+/**
+ * @brief scanRichLogLine 的向量版本（SSE2 或 WebAssembly SIMD），结果完全相同
+ *
+ * 用 16 字节并行比较查找 "RICHLOG:" 和十六进制数据的结尾；两者都不支持的平台上等同于 scanRichLogLine。
+ */
+bool scanRichLogLineSimd(std::string_view line, RichLogLineView& view);
+
+/**
+ * @brief 从 from 开始查找 "RICHLOG:" 标记，不要求 text 是单行
+ *
+ * 支持 SSE2 或 WebAssembly SIMD 时一次比较 16 个位置，用于在整段日志中跳到下一条 RICHLOG 行。
+ * @return 标记的偏移，找不到时为 std::string_view::npos
+ */
+size_t findRichLogMarker(std::string_view text, size_t from = 0);
+
+/**
+ * @brief 十六进制解码，输出 hex.size() / 2 个字节（与 RichLogParser 一样忽略末尾落单的字符）
+ * @param hex 十六进制字符串
+ * @param out 输出缓冲区，至少 hex.size() / 2 字节
+ * @return 是否全部为合法十六进制字符
+ */
+bool decodeHex(std::string_view hex, uint8_t* out);
+
+/**
+ * @brief 十六进制解码并追加到 out 末尾
+ */
+bool decodeHex(std::string_view hex, std::vector<uint8_t>& out);
+
+/**
+ * @brief 以小写十六进制追加到 out 末尾
+ */
+void appendHex(std::string& out, const uint8_t* data, size_t size);
+
+/**
+ * @brief 基于 scanRichLogLine 和查表解码的解析器，语义与 RichLogParser 相同
+ */
+class FastRichLogParser : public Parser {
+public:
+    std::unique_ptr<RichLogBlock> parse(const std::string& logLine) override;
+    bool isRichLogFormat(const std::string& logLine) override;
+};
+
+/**
+ * @brief 基于 scanRichLogLineSimd 和向量化十六进制解码的解析器，语义与 RichLogParser 相同
+ */
+class SimdRichLogParser : public Parser {
+public:
+    std::unique_ptr<RichLogBlock> parse(const std::string& logLine) override;
+    bool isRichLogFormat(const std::string& logLine) override;
+};
+
+} // namespace richlog
+
+#endif // RICHLOG_SCANNER_HPP
@@ -0,0 +1,173 @@
+#ifndef RICHLOG_STREAM_PARSER_HPP
+#define RICHLOG_STREAM_PARSER_HPP
+
+#include "reassembler.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <istream>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace richlog {
+
+/**
+ * @brief 日志行在文件中的位置
+ */
+struct LineLocation {
+    uint64_t line = 0;      // 行号（从 0 开始）
+    uint64_t offset = 0;    // 行首字节偏移
+};
+
+/**
+ * @brief StreamParser 的检查点
+ *
+ * 不保存分片数据，只保存需要重放的日志行位置：尚未交给调用方的载荷（含未收齐的
+ * 分片和等待中的引用），以及去重引用可能指向的最近完成载荷。恢复时只重读这些行，
+ * 代价与未完成的载荷数量相关，与文件大小无关。另外保存重组器记住的已结束 uuid，
+ * 恢复后迟到的重复分片与不中断时一样被丢弃。
+ */
+struct StreamCheckpoint {
+    struct Entry {
+        std::string uuid;
+        std::vector<LineLocation> lines;
+    };
+
+    uint64_t offset = 0;            // 继续读取的字节偏移（总在行首）
+    uint64_t line = 0;              // offset 处的行号
+    std::vector<Entry> pending;     // 尚未交给调用方的载荷
+    std::vector<Entry> recent;      // 最近完成的载荷，最近使用的在前
+    std::vector<std::string> finished; // 已完成或丢弃的 uuid，顺序同 ShardedReassembler::finishedUuids
+
+    /**
+     * @brief 序列化为文本
+     */
+    std::string serialize() const;
+
+    /**
+     * @brief 从 serialize() 的输出解析
+     * @return 格式是否正确
+     */
+    static bool parse(const std::string& text, StreamCheckpoint& checkpoint);
+
+    /**
+     * @brief 写入文件，先写临时文件再重命名，中途崩溃不会留下不完整的检查点
+     */
+    bool save(const std::string& path) const;
+
+    /**
+     * @brief 从文件读取，文件不存在或格式错误时返回 false
+     */
+    static bool load(const std::string& path, StreamCheckpoint& checkpoint);
+};
+
+/**
+ * @brief 流式日志解析器
+ *
+ * 接收任意切分的字节块（例如 Blob.stream() 或 read() 的结果），按换行拆分成行，
+ * 跨块的不完整行会缓存到下一次 feed。RichLog 行直接扫描并交给重组器，
+ * 序号为行号（从 0 开始，空行也计数）。
+ *
+ * 第一行距当前行超过 maxPendingLines 仍未完成的载荷（截断的载荷、被引用载荷
+ * 始终没有出现的引用）会被放弃，检查点和恢复的代价不随文件历史增长。
+ */
+class StreamParser {
+public:
+    static constexpr uint64_t kDefaultMaxPendingLines = 1 << 20;
+
+    /**
+     * @param options 重组器配置
+     * @param maxPendingLines 未完成载荷的最大跨度（行数），0 表示不限制
+     */
+    explicit StreamParser(const ReassemblerOptions& options = ReassemblerOptions(),
+                          uint64_t maxPendingLines = kDefaultMaxPendingLines);
+
+    /**
+     * @brief 输入一块数据
+     * @param data 数据指针
+     * @param size 数据长度
+     */
+    void feed(const char* data, size_t size);
+
+    /**
+     * @brief 输入结束，处理末尾没有换行符的最后一行
+     */
+    void finish();
+
+    /**
+     * @brief 取出目前所有已完成的载荷
+     */
+    std::vector<ReassembledPayload> takeCompleted();
+
+    /**
+     * @brief 已完整处理的字节数（不含缓存中的不完整行）
+     */
+    uint64_t bytesConsumed() const { return consumed_; }
+
+    /**
+     * @brief 已处理的行数
+     */
+    uint64_t linesProcessed() const { return lineNumber_; }
+
+    /**
+     * @brief 尚未收齐分片的载荷数量
+     */
+    size_t pendingCount() const { return reassembler_.pendingCount(); }
+
+    /**
+     * @brief 生成检查点
+     *
+     * 已由 takeCompleted 取走的载荷视为已处理，其余载荷在恢复后会重新输出，
+     * 因此应在处理完 takeCompleted 的结果之后再保存检查点。
+     */
+    StreamCheckpoint checkpoint() const;
+
+    /**
+     * @brief 在新建的解析器上恢复检查点
+     *
+     * 从 input 中重读检查点记录的行，之后调用方应从 checkpoint.offset 处继续 feed。
+     * @param checkpoint 检查点
+     * @param input 与生成检查点时相同的日志文件
+     * @return 文件比检查点短或记录的行无法读取时返回 false，解析器状态不确定
+     */
+    bool restore(const StreamCheckpoint& checkpoint, std::istream& input);
+
+private:
+    struct InFlight {
+        std::vector<LineLocation> lines;
+        std::string target;     // 引用块指向的 uuid，普通载荷为空
+    };
+
+    struct RecentPayload {
+        std::string uuid;
+        std::vector<LineLocation> lines;
+    };
+
+    void processLine(std::string_view line, uint64_t offset);
+    void processLine(std::string_view line, uint64_t offset, uint64_t lineNumber);
+    void forgetDropped();
+    void expireStale();
+    void touchRecent(const std::string& uuid);
+    void rememberRecent(const std::string& uuid, std::vector<LineLocation> lines);
+
+    ShardedReassembler reassembler_;
+    std::string partial_;
+    uint64_t consumed_ = 0;
+    uint64_t lineNumber_ = 0;
+
+    // 检查点所需的行位置：与重组器的引用缓存保持同样的容量和淘汰顺序
+    size_t referenceCacheSize_;
+    std::unordered_map<std::string, InFlight> inFlight_;
+    uint64_t maxPendingLines_;
+    std::deque<std::pair<uint64_t, std::string>> firstLines_;  // 按出现顺序记录的 (首行行号, uuid)
+    std::list<RecentPayload> recent_;  // 最近使用的在前
+    std::unordered_map<std::string, std::list<RecentPayload>::iterator> recentIndex_;
+    std::vector<ReassembledPayload> restored_;  // 恢复时重放出的、尚未取走的载荷
+};
+
+} // namespace richlog
+
+#endif // RICHLOG_STREAM_PARSER_HPP
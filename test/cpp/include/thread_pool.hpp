@@ -0,0 +1,121 @@
+#ifndef RICHLOG_THREAD_POOL_HPP
+#define RICHLOG_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace richlog {
+
+/**
+ * @brief 线程池配置
+ */
+struct ThreadPoolOptions {
+    size_t threadCount = 0;         // 工作线程数，0 表示使用硬件并发数
+    std::vector<int> cpuAffinity;   // 第 i 个线程绑定到 cpuAffinity[i % size]，为空则不绑定
+};
+
+/**
+ * @brief 工作窃取线程池
+ *
+ * 每个工作线程持有自己的任务双端队列：本线程从队尾取任务（LIFO，缓存友好），
+ * 空闲线程从其他队列的队首窃取任务（FIFO）。扫描区间、重组分片和载荷解码
+ * 都可以提交到同一个线程池，大小不一的任务会自动在各核心之间均衡。
+ */
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit ThreadPool(size_t threadCount = 0);
+    explicit ThreadPool(const ThreadPoolOptions& options);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief 工作线程数量
+     */
+    size_t size() const { return threads_.size(); }
+
+    /**
+     * @brief 提交任务并返回 future，任务抛出的异常通过 future 传递
+     * @param func 可调用对象
+     * @return 任务结果的 future
+     */
+    template <typename F>
+    auto submit(F&& func) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using Result = std::invoke_result_t<std::decay_t<F>>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(func));
+        auto future = task->get_future();
+        post([task]() { (*task)(); });
+        return future;
+    }
+
+    /**
+     * @brief 提交不需要返回值的任务
+     *
+     * 在工作线程内调用时任务进入本线程队列，否则轮询分配到各队列。
+     */
+    void post(Task task);
+
+    /**
+     * @brief 并行处理区间 [begin, end)
+     *
+     * 区间按 grainSize 切分，调用线程本身也参与执行，因此可以在任务内部嵌套调用
+     * 而不会死锁。body 抛出的第一个异常会在所有分片结束后重新抛出。
+     * @param begin 起始下标
+     * @param end 结束下标（不含）
+     * @param grainSize 每个分片的大小，0 表示自动选择
+     * @param body 处理 [chunkBegin, chunkEnd) 的函数
+     */
+    void parallelFor(size_t begin, size_t end, size_t grainSize,
+                     const std::function<void(size_t, size_t)>& body);
+
+    /**
+     * @brief 等待所有已提交任务执行完毕（不要在工作线程中调用）
+     */
+    void waitIdle();
+
+    /**
+     * @brief 当前线程在本线程池中的工作线程编号，非工作线程返回 npos
+     */
+    size_t currentWorkerIndex() const;
+
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void start(const ThreadPoolOptions& options);
+    void workerLoop(size_t index);
+    bool popLocal(size_t index, Task& task);
+    bool steal(size_t thief, Task& task);
+    void finishTask();
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread> threads_;
+
+    std::mutex sleepMutex_;
+    std::condition_variable wakeCondition_;
+    std::condition_variable idleCondition_;
+    std::atomic<size_t> queuedTasks_{0};   // 已入队但尚未被取走的任务
+    std::atomic<size_t> pendingTasks_{0};  // 已入队或正在执行的任务
+    std::atomic<size_t> nextQueue_{0};
+    bool stopping_ = false;
+};
+
+} // namespace richlog
+
+#endif // RICHLOG_THREAD_POOL_HPP
@@ -0,0 +1,168 @@
+#include "parser_harness.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace richlog;
+
+namespace {
+
+void printUsage() {
+    std::cerr << "用法: parser_diff [选项] [日志文件...]\n"
+              << "\n"
+              << "在相同输入上运行所有解析器实现（reference、fast、simd），报告结果差异和各自的吞吐量。\n"
+              << "未指定日志文件时使用随机生成的语料。\n"
+              << "\n"
+              << "选项:\n"
+              << "  --lines <行数>      生成的语料行数，默认 100000\n"
+              << "  --seed <种子>       语料随机种子，默认 1\n"
+              << "  --corpus <文件>     写出输入行，供 test/js/parser-parity.js 使用\n"
+              << "  --expected <文件>   写出参考实现的结果，每行一个 JSON\n";
+}
+
+// 按 '\n' 切分，文件末尾的换行不产生空行
+bool readLines(const std::string& path, std::vector<std::string>& lines) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        lines.push_back(line);
+    }
+    return true;
+}
+
+// 不可打印字节输出为 \xNN
+std::string escapeLine(const std::string& line) {
+    static const char* hexChars = "0123456789abcdef";
+    std::string out;
+    for (char c : line) {
+        uint8_t byte = static_cast<uint8_t>(c);
+        if (byte < 0x20 || byte >= 0x7f || c == '\\') {
+            out += "\\x";
+            out += hexChars[byte >> 4];
+            out += hexChars[byte & 0x0F];
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+bool writeLines(const std::string& path, const std::vector<std::string>& lines) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    for (const auto& line : lines) {
+        file.write(line.data(), static_cast<std::streamsize>(line.size()));
+        file.put('\n');
+    }
+    return static_cast<bool>(file.flush());
+}
+
+void printReport(const ParserDiffReport& report) {
+    double megabytes = static_cast<double>(report.bytes) / (1024.0 * 1024.0);
+    std::cout << "📊 输入: " << report.lines << " 行, " << std::fixed << std::setprecision(2) << megabytes
+              << " MB\n\n";
+    // 表头含中文，setw 按字节计算宽度，直接写出对齐后的文本
+    std::cout << "实现            耗时(ms)        MB/s         行/秒      匹配    加速比\n";
+
+    double baseline = report.throughput.empty() ? 0 : report.throughput[0].seconds;
+    for (const auto& entry : report.throughput) {
+        double seconds = std::max(entry.seconds, 1e-9);
+        std::cout << std::left << std::setw(12) << entry.name << std::right << std::setw(12)
+                  << std::setprecision(1) << seconds * 1000 << std::setw(12) << megabytes / seconds
+                  << std::setw(14) << std::setprecision(0) << report.lines / seconds << std::setw(10)
+                  << entry.matched << std::setw(9) << std::setprecision(1) << baseline / seconds << "x\n";
+    }
+
+    std::cout << "\n";
+    if (report.divergenceCount == 0) {
+        std::cout << "✅ 所有实现结果一致" << std::endl;
+        return;
+    }
+    std::cout << "❌ " << report.divergenceCount << " 行结果不一致" << std::endl;
+    for (const auto& divergence : report.divergences) {
+        std::cout << "\n第 " << divergence.line + 1 << " 行: " << escapeLine(divergence.input) << "\n";
+        for (size_t i = 0; i < divergence.results.size(); ++i) {
+            std::cout << "  " << std::left << std::setw(10) << report.throughput[i].name
+                      << divergence.results[i] << "\n";
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t lineCount = 100000;
+    uint32_t seed = 1;
+    std::string corpusPath;
+    std::string expectedPath;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--lines" || arg == "--seed" || arg == "--corpus" || arg == "--expected") {
+            if (i + 1 >= argc) {
+                std::cerr << "❌ 选项缺少参数: " << arg << std::endl;
+                return 2;
+            }
+            std::string value = argv[++i];
+            if (arg == "--lines") {
+                lineCount = static_cast<size_t>(std::strtoull(value.c_str(), nullptr, 10));
+            } else if (arg == "--seed") {
+                seed = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+            } else if (arg == "--corpus") {
+                corpusPath = value;
+            } else {
+                expectedPath = value;
+            }
+        } else if (arg == "-h" || arg == "--help") {
+            printUsage();
+            return 0;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::cerr << "❌ 未知选项: " << arg << std::endl;
+            return 2;
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+
+    std::vector<std::string> lines;
+    if (inputs.empty()) {
+        lines = generateParserCorpus(lineCount, seed);
+    }
+    for (const auto& path : inputs) {
+        if (!readLines(path, lines)) {
+            std::cerr << "❌ 无法打开文件: " << path << std::endl;
+            return 2;
+        }
+    }
+
+    ParserDiffHarness harness;
+    ParserDiffReport report = harness.run(lines);
+    printReport(report);
+
+    if (!corpusPath.empty() && !writeLines(corpusPath, lines)) {
+        std::cerr << "❌ 无法写入文件: " << corpusPath << std::endl;
+        return 2;
+    }
+    if (!expectedPath.empty()) {
+        auto reference = makeParserImplementations();
+        std::vector<std::string> expected;
+        expected.reserve(lines.size());
+        for (const auto& line : lines) {
+            expected.push_back(describeParseResult(reference[0].parser->parse(line).get()));
+        }
+        if (!writeLines(expectedPath, expected)) {
+            std::cerr << "❌ 无法写入文件: " << expectedPath << std::endl;
+            return 2;
+        }
+    }
+    return report.divergenceCount == 0 ? 0 : 1;
+}
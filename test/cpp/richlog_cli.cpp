@@ -0,0 +1,217 @@
+#include "log_search.hpp"
+#include "log_stats.hpp"
+#include "thread_pool.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace richlog;
+
+namespace {
+
+void printUsage() {
+    std::cerr << "用法: richlog_cli <命令> [选项] <日志文件>\n"
+              << "\n"
+              << "命令:\n"
+              << "  search    过滤日志行（普通行和 RICHLOG 行）；可指定多个日志文件，输出行前加文件名\n"
+              << "  stats     按类型统计载荷数量、大小分布和不完整率，输出 JSON；可指定多个日志文件\n"
+              << "\n"
+              << "search 选项:\n"
+              << "  -e <文本>       行内包含该文本，可重复，任意一个匹配即可\n"
+              << "  --type <类型>   只输出该类型的 RICHLOG 行\n"
+              << "  --uuid <uuid>   只输出该 uuid 的 RICHLOG 行\n"
+              << "  --richlog       只输出 RICHLOG 行\n"
+              << "  -n              输出行号\n"
+              << "  -c              只输出匹配行数\n"
+              << "  -j <线程数>     默认使用全部核心\n"
+              << "\n"
+              << "stats 选项:\n"
+              << "  --samples <数量> 每种类型列出的不完整或无效载荷数，默认 5\n"
+              << "  -j <线程数>      默认使用全部核心\n";
+}
+
+// 选项缺少参数时返回 nullptr
+const char* nextArgument(int argc, char* argv[], int& i) {
+    return i + 1 < argc ? argv[++i] : nullptr;
+}
+
+int runSearch(int argc, char* argv[]) {
+    SearchQuery query;
+    bool lineNumbers = false;
+    bool countOnly = false;
+    size_t threads = 0;
+    std::vector<std::string> paths;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char* value = nullptr;
+        if (arg == "-e" || arg == "--type" || arg == "--uuid" || arg == "-j") {
+            value = nextArgument(argc, argv, i);
+            if (!value) {
+                std::cerr << "❌ 选项缺少参数: " << arg << std::endl;
+                return 2;
+            }
+        }
+        if (arg == "-e") {
+            query.literals.push_back(value);
+        } else if (arg == "--type") {
+            query.type = value;
+        } else if (arg == "--uuid") {
+            query.uuid = value;
+        } else if (arg == "-j") {
+            threads = static_cast<size_t>(std::strtoul(value, nullptr, 10));
+        } else if (arg == "--richlog") {
+            query.richlogOnly = true;
+        } else if (arg == "-n") {
+            lineNumbers = true;
+        } else if (arg == "-c") {
+            countOnly = true;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::cerr << "❌ 未知选项: " << arg << std::endl;
+            return 2;
+        } else {
+            paths.push_back(arg);
+        }
+    }
+    if (paths.empty()) {
+        printUsage();
+        return 2;
+    }
+
+    ThreadPool pool(threads);
+    LogSearcher searcher(query);
+    // 与 grep 一致：多个文件时每行前加 "文件名:"，打不开的文件报错后继续搜索其余文件
+    bool withPath = paths.size() > 1;
+    bool anyMatch = false;
+    bool failed = false;
+    for (const auto& path : paths) {
+        MappedFile file;
+        if (!file.open(path)) {
+            std::fflush(stdout);
+            std::cerr << "❌ 无法打开文件: " << path << std::endl;
+            failed = true;
+            continue;
+        }
+
+        auto matches = searcher.search(pool, file.view());
+        anyMatch = anyMatch || !matches.empty();
+        if (countOnly) {
+            std::cout << (withPath ? path + ":" : "") << matches.size() << std::endl;
+            continue;
+        }
+
+        // 攒批输出，避免逐行写入
+        std::string output;
+        output.reserve(1 << 20);
+        for (const auto& match : matches) {
+            if (withPath) {
+                output += path;
+                output += ':';
+            }
+            if (lineNumbers) {
+                output += std::to_string(match.lineNumber);
+                output += ':';
+            }
+            output.append(match.line.data(), match.line.size());
+            output += '\n';
+            if (output.size() >= (1 << 20)) {
+                std::fwrite(output.data(), 1, output.size(), stdout);
+                output.clear();
+            }
+        }
+        std::fwrite(output.data(), 1, output.size(), stdout);
+    }
+    // 与 grep 一致：有匹配返回 0，没有匹配返回 1，有文件无法打开时返回 2
+    if (failed) {
+        return 2;
+    }
+    return anyMatch ? 0 : 1;
+}
+
+int runStats(int argc, char* argv[]) {
+    size_t sampleLimit = LogStatsCollector::kDefaultSampleLimit;
+    size_t threads = 0;
+    std::vector<std::string> paths;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--samples" || arg == "-j") {
+            const char* value = nextArgument(argc, argv, i);
+            if (!value) {
+                std::cerr << "❌ 选项缺少参数: " << arg << std::endl;
+                return 2;
+            }
+            size_t number = static_cast<size_t>(std::strtoul(value, nullptr, 10));
+            if (arg == "-j") {
+                threads = number;
+            } else {
+                sampleLimit = number;
+            }
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::cerr << "❌ 未知选项: " << arg << std::endl;
+            return 2;
+        } else {
+            paths.push_back(arg);
+        }
+    }
+    if (paths.empty()) {
+        printUsage();
+        return 2;
+    }
+
+    ThreadPool pool(threads);
+    LogStatsCollector collector(sampleLimit);
+    // 单个文件输出一个对象，多个文件输出对象数组；与 search 一致，打不开的文件
+    // 报错后跳过，继续统计其余文件，最后返回 2
+    bool asArray = paths.size() > 1;
+    std::string output = asArray ? "[" : "";
+    bool firstEntry = true;
+    bool failed = false;
+    for (const auto& path : paths) {
+        MappedFile file;
+        if (!file.open(path)) {
+            std::cerr << "❌ 无法打开文件: " << path << std::endl;
+            failed = true;
+            continue;
+        }
+        output += firstEntry ? (asArray ? "\n" : "") : ",\n";
+        firstEntry = false;
+        output += formatLogStatsJson(collector.collect(pool, file.view()), path);
+    }
+    if (!firstEntry) {
+        output += '\n';
+    }
+    if (asArray) {
+        output += "]\n";
+    }
+    std::fwrite(output.data(), 1, output.size(), stdout);
+    return failed ? 2 : 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage();
+        return 2;
+    }
+
+    std::string command = argv[1];
+    try {
+        if (command == "search") {
+            return runSearch(argc, argv);
+        }
+        if (command == "stats") {
+            return runStats(argc, argv);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "❌ " << e.what() << std::endl;
+        return 2;
+    }
+
+    printUsage();
+    return 2;
+}
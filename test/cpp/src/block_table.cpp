@@ -0,0 +1,238 @@
+#include "block_table.hpp"
+#include "scanner.hpp"
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define RICHLOG_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define RICHLOG_PREFETCH(address) ((void)0)
+#endif
+
+namespace richlog {
+
+namespace {
+
+// 拼接时提前预取的分片数：同一载荷的分片在缓冲区中与其他载荷交错存放
+constexpr size_t kPrefetchDistance = 4;
+
+void gatherPayloads(const BlockTable& table, const std::vector<const BlockRecord*>& parts,
+                    std::vector<uint8_t>& out) {
+    size_t totalSize = 0;
+    for (const BlockRecord* part : parts) {
+        totalSize += part->length;
+    }
+    out.resize(totalSize);
+
+    uint8_t* cursor = out.data();
+    for (size_t i = 0; i < parts.size(); ++i) {
+        if (i + kPrefetchDistance < parts.size()) {
+            RICHLOG_PREFETCH(table.payload(*parts[i + kPrefetchDistance]));
+        }
+        if (parts[i]->length > 0) {
+            std::memcpy(cursor, table.payload(*parts[i]), parts[i]->length);
+            cursor += parts[i]->length;
+        }
+    }
+}
+
+} // namespace
+
+// BlockTable 实现
+void BlockTable::reserve(size_t blocks, size_t payloadBytes) {
+    records_.reserve(blocks);
+    payload_.reserve(payloadBytes);
+}
+
+uint32_t BlockTable::internType(std::string_view type) {
+    std::string key(type);
+    auto it = typeIds_.find(key);
+    if (it != typeIds_.end()) {
+        return it->second;
+    }
+    uint32_t id = static_cast<uint32_t>(types_.size());
+    types_.push_back(key);
+    typeIds_.emplace(std::move(key), id);
+    return id;
+}
+
+uint64_t BlockTable::internUuid(std::string_view uuid) {
+    std::string key(uuid);
+    auto it = uuidIds_.find(key);
+    if (it != uuidIds_.end()) {
+        return it->second;
+    }
+    uint64_t id = static_cast<uint64_t>(uuids_.size());
+    uuids_.push_back(key);
+    uuidIds_.emplace(std::move(key), id);
+    return id;
+}
+
+size_t BlockTable::appendRecord(std::string_view type, std::string_view uuid, uint32_t index,
+                                uint32_t total, size_t length) {
+    if (length > std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("BlockTable: 单个载荷超过 4 GiB");
+    }
+    // 同一载荷的分片通常相邻，先与上一条记录比较，省去一次哈希查找
+    BlockRecord record;
+    if (!records_.empty() && uuids_[records_.back().uuid] == uuid) {
+        record.uuid = records_.back().uuid;
+    } else {
+        record.uuid = internUuid(uuid);
+    }
+    if (!records_.empty() && types_[records_.back().typeId] == type) {
+        record.typeId = records_.back().typeId;
+    } else {
+        record.typeId = internType(type);
+    }
+    record.index = index;
+    record.total = total;
+    record.length = static_cast<uint32_t>(length);
+    record.offset = payload_.size();
+    records_.push_back(record);
+    return records_.size() - 1;
+}
+
+size_t BlockTable::append(const RichLogBlock& block) {
+    size_t position = appendRecord(block.type, block.uuid, block.index, block.total, block.data.size());
+    payload_.insert(payload_.end(), block.data.begin(), block.data.end());
+    return position;
+}
+
+bool BlockTable::append(const RichLogLineView& view) {
+    size_t length = view.hex.size() / 2;
+    appendRecord(view.type, view.uuid, view.index, view.total, length);
+    size_t offset = payload_.size();
+    payload_.resize(offset + length);
+    if (!decodeHex(view.hex, payload_.data() + offset)) {
+        payload_.resize(offset);
+        records_.pop_back();
+        return false;
+    }
+    return true;
+}
+
+RichLogBlock BlockTable::toBlock(const BlockRecord& record) const {
+    RichLogBlock block(types_[record.typeId], uuids_[record.uuid], record.index, record.total);
+    const uint8_t* data = payload(record);
+    block.data.assign(data, data + record.length);
+    return block;
+}
+
+std::vector<BlockRange> BlockTable::groupByUuid() {
+    // 每个 uuid 的起始位置
+    std::vector<size_t> starts(uuids_.size() + 1, 0);
+    for (const auto& record : records_) {
+        ++starts[record.uuid + 1];
+    }
+    for (size_t i = 1; i < starts.size(); ++i) {
+        starts[i] += starts[i - 1];
+    }
+
+    std::vector<BlockRecord> grouped(records_.size());
+    std::vector<size_t> next(starts.begin(), starts.end() - 1);
+    for (const auto& record : records_) {
+        grouped[next[record.uuid]++] = record;
+    }
+    records_.swap(grouped);
+
+    std::vector<BlockRange> ranges;
+    for (size_t id = 0; id + 1 < starts.size(); ++id) {
+        if (starts[id + 1] > starts[id]) {
+            ranges.push_back(BlockRange{id, starts[id], starts[id + 1] - starts[id]});
+        }
+    }
+    return ranges;
+}
+
+void BlockTable::clear() {
+    records_.clear();
+    payload_.clear();
+    types_.clear();
+    uuids_.clear();
+    typeIds_.clear();
+    uuidIds_.clear();
+}
+
+// RichLogDecoder 的 BlockTable 重载
+bool RichLogDecoder::validateBlocks(const BlockTable& table, const BlockRange& range) const {
+    if (range.count == 0 || range.begin + range.count > table.size()) {
+        return false;
+    }
+
+    const BlockRecord* records = table.records().data() + range.begin;
+    const BlockRecord& first = records[0];
+    bool inOrder = true;
+    for (size_t i = 0; i < range.count; ++i) {
+        const BlockRecord& record = records[i];
+        if (record.uuid != first.uuid || record.typeId != first.typeId || record.total != range.count) {
+            return false;
+        }
+        inOrder = inOrder && record.index == i + 1;
+    }
+    if (inOrder) {
+        return true;
+    }
+
+    // 乱序时用位图检查索引是否恰好覆盖 1..total
+    std::vector<uint64_t> seen((range.count + 63) / 64, 0);
+    for (size_t i = 0; i < range.count; ++i) {
+        uint32_t index = records[i].index;
+        if (index == 0 || index > range.count) {
+            return false;
+        }
+        uint64_t bit = uint64_t(1) << ((index - 1) % 64);
+        uint64_t& word = seen[(index - 1) / 64];
+        if (word & bit) {
+            return false;
+        }
+        word |= bit;
+    }
+    return true;
+}
+
+std::vector<uint8_t> RichLogDecoder::decode(const BlockTable& table, const BlockRange& range) const {
+    if (range.count == 0 || range.begin + range.count > table.size()) {
+        return {};
+    }
+    const BlockRecord* records = table.records().data() + range.begin;
+    const BlockRecord& first = records[0];
+    if (duplicatePolicy_ == DuplicatePolicy::Reject) {
+        if (!validateBlocks(table, range)) {
+            return {};
+        }
+    } else if (first.total == 0 || first.total > range.count) {
+        return {};
+    }
+
+    // 按索引就位，第一份到达的分片生效
+    std::vector<const BlockRecord*> slots(first.total, nullptr);
+    size_t received = 0;
+    for (size_t i = 0; i < range.count; ++i) {
+        const BlockRecord& record = records[i];
+        if (record.uuid != first.uuid || record.typeId != first.typeId || record.total != first.total ||
+            record.index == 0 || record.index > record.total) {
+            return {};
+        }
+        const BlockRecord*& slot = slots[record.index - 1];
+        if (!slot) {
+            slot = &record;
+            ++received;
+        } else if (duplicatePolicy_ == DuplicatePolicy::VerifyChecksum &&
+                   (slot->length != record.length ||
+                    (record.length > 0 &&
+                     std::memcmp(table.payload(*slot), table.payload(record), record.length) != 0))) {
+            return {};
+        }
+    }
+    if (received != slots.size()) {
+        return {};
+    }
+
+    std::vector<uint8_t> result;
+    gatherPayloads(table, slots, result);
+    return result;
+}
+
+} // namespace richlog
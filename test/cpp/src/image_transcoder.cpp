@@ -0,0 +1,577 @@
+#include "image_transcoder.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace richlog {
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// deflate（RFC 1951，固定霍夫曼编码）与 zlib 封装（RFC 1950）
+// ---------------------------------------------------------------------------
+
+constexpr uint16_t kLengthBase[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr uint8_t kLengthExtra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr uint16_t kDistanceBase[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+constexpr uint8_t kDistanceExtra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+// 按 LSB 优先顺序写入比特流
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) : out_(out) {}
+
+    void writeBits(uint32_t value, unsigned count) {
+        buffer_ |= static_cast<uint64_t>(value) << count_;
+        count_ += count;
+        while (count_ >= 8) {
+            out_.push_back(static_cast<uint8_t>(buffer_));
+            buffer_ >>= 8;
+            count_ -= 8;
+        }
+    }
+
+    // 霍夫曼码按 MSB 优先存储，写入前先反转
+    void writeCode(uint32_t code, unsigned length) {
+        uint32_t reversed = 0;
+        for (unsigned i = 0; i < length; ++i) {
+            reversed = (reversed << 1) | ((code >> i) & 1);
+        }
+        writeBits(reversed, length);
+    }
+
+    void alignToByte() {
+        if (count_ > 0) {
+            out_.push_back(static_cast<uint8_t>(buffer_));
+            buffer_ = 0;
+            count_ = 0;
+        }
+    }
+
+private:
+    std::vector<uint8_t>& out_;
+    uint64_t buffer_ = 0;
+    unsigned count_ = 0;
+};
+
+// 流式 zlib 压缩器：输入按段压缩，段之间保留 32KB 窗口供匹配
+class Deflater {
+public:
+    explicit Deflater(ByteSink sink) : sink_(std::move(sink)), bits_(out_) {
+        head_.assign(kHashSize, -1);
+        out_.push_back(0x78);   // CM = 8，窗口 32KB
+        out_.push_back(0x01);   // 无预设字典，最快压缩级别
+    }
+
+    void write(const uint8_t* data, size_t size) {
+        updateAdler(data, size);
+        buffer_.insert(buffer_.end(), data, data + size);
+        while (buffer_.size() - historySize_ >= kSegmentSize) {
+            compressPending(false);
+        }
+    }
+
+    void finish() {
+        compressPending(true);
+        bits_.alignToByte();
+        uint32_t adler = (adlerB_ << 16) | adlerA_;
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            out_.push_back(static_cast<uint8_t>(adler >> shift));
+        }
+        flushOutput();
+    }
+
+private:
+    static constexpr size_t kWindowSize = 32768;
+    static constexpr size_t kSegmentSize = 65536;
+    static constexpr size_t kHashSize = 1 << 15;
+    static constexpr size_t kMinMatch = 3;
+    static constexpr size_t kMaxMatch = 258;
+    static constexpr int kMaxChain = 64;
+
+    size_t hashAt(size_t pos) const {
+        uint32_t value = (static_cast<uint32_t>(buffer_[pos]) << 16) |
+                         (static_cast<uint32_t>(buffer_[pos + 1]) << 8) | buffer_[pos + 2];
+        return (value * 2654435761u) >> (32 - 15);
+    }
+
+    void insertHash(size_t pos) {
+        size_t hash = hashAt(pos);
+        prev_[pos] = head_[hash];
+        head_[hash] = static_cast<int32_t>(pos);
+    }
+
+    void updateAdler(const uint8_t* data, size_t size) {
+        // 5552 是保证 32 位累加不溢出的最大批量
+        while (size > 0) {
+            size_t batch = std::min<size_t>(size, 5552);
+            for (size_t i = 0; i < batch; ++i) {
+                adlerA_ += data[i];
+                adlerB_ += adlerA_;
+            }
+            adlerA_ %= 65521;
+            adlerB_ %= 65521;
+            data += batch;
+            size -= batch;
+        }
+    }
+
+    void writeLiteral(uint32_t symbol) {
+        if (symbol < 144) {
+            bits_.writeCode(0x30 + symbol, 8);
+        } else if (symbol < 256) {
+            bits_.writeCode(0x190 + symbol - 144, 9);
+        } else if (symbol < 280) {
+            bits_.writeCode(symbol - 256, 7);
+        } else {
+            bits_.writeCode(0xC0 + symbol - 280, 8);
+        }
+    }
+
+    void writeMatch(size_t length, size_t distance) {
+        size_t code = std::upper_bound(std::begin(kLengthBase), std::end(kLengthBase), length) -
+                      std::begin(kLengthBase) - 1;
+        writeLiteral(static_cast<uint32_t>(257 + code));
+        bits_.writeBits(static_cast<uint32_t>(length - kLengthBase[code]), kLengthExtra[code]);
+
+        code = std::upper_bound(std::begin(kDistanceBase), std::end(kDistanceBase), distance) -
+               std::begin(kDistanceBase) - 1;
+        bits_.writeCode(static_cast<uint32_t>(code), 5);
+        bits_.writeBits(static_cast<uint32_t>(distance - kDistanceBase[code]), kDistanceExtra[code]);
+    }
+
+    void compressPending(bool final) {
+        bits_.writeBits(final ? 1 : 0, 1);
+        bits_.writeBits(1, 2);  // BTYPE = 01，固定霍夫曼编码
+
+        const size_t end = buffer_.size();
+        prev_.resize(end, -1);
+        size_t pos = historySize_;
+        while (pos < end) {
+            size_t bestLength = 0;
+            size_t bestDistance = 0;
+            if (pos + kMinMatch <= end) {
+                size_t maxLength = std::min(kMaxMatch, end - pos);
+                int32_t candidate = head_[hashAt(pos)];
+                for (int chain = kMaxChain; candidate >= 0 && chain > 0; --chain) {
+                    size_t distance = pos - static_cast<size_t>(candidate);
+                    if (distance > kWindowSize) {
+                        break;
+                    }
+                    const uint8_t* a = buffer_.data() + candidate;
+                    const uint8_t* b = buffer_.data() + pos;
+                    size_t length = 0;
+                    while (length < maxLength && a[length] == b[length]) {
+                        ++length;
+                    }
+                    if (length > bestLength) {
+                        bestLength = length;
+                        bestDistance = distance;
+                        if (length == maxLength) {
+                            break;
+                        }
+                    }
+                    candidate = prev_[candidate];
+                }
+                insertHash(pos);
+            }
+
+            if (bestLength >= kMinMatch) {
+                writeMatch(bestLength, bestDistance);
+                for (size_t i = 1; i < bestLength && pos + i + kMinMatch <= end; ++i) {
+                    insertHash(pos + i);
+                }
+                pos += bestLength;
+            } else {
+                writeLiteral(buffer_[pos]);
+                ++pos;
+            }
+        }
+        writeLiteral(256);  // 块结束
+
+        // 只保留最后 32KB 作为下一段的匹配窗口，并重建哈希链
+        size_t keep = std::min(kWindowSize, buffer_.size());
+        buffer_.erase(buffer_.begin(), buffer_.end() - static_cast<std::ptrdiff_t>(keep));
+        historySize_ = keep;
+        std::fill(head_.begin(), head_.end(), -1);
+        prev_.assign(keep, -1);
+        for (size_t i = 0; i + kMinMatch <= keep; ++i) {
+            insertHash(i);
+        }
+        flushOutput();
+    }
+
+    void flushOutput() {
+        if (!out_.empty()) {
+            sink_(out_.data(), out_.size());
+            out_.clear();
+        }
+    }
+
+    ByteSink sink_;
+    std::vector<uint8_t> out_;
+    BitWriter bits_;
+    std::vector<uint8_t> buffer_;   // 匹配窗口 + 待压缩数据
+    size_t historySize_ = 0;
+    std::vector<int32_t> head_;
+    std::vector<int32_t> prev_;
+    uint32_t adlerA_ = 1;
+    uint32_t adlerB_ = 0;
+};
+
+// ---------------------------------------------------------------------------
+// PNG 输出
+// ---------------------------------------------------------------------------
+
+constexpr std::array<uint32_t, 256> makeCrcTable() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t n = 0; n < 256; ++n) {
+        uint32_t c = n;
+        for (int k = 0; k < 8; ++k) {
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        table[n] = c;
+    }
+    return table;
+}
+
+constexpr std::array<uint32_t, 256> kCrcTable = makeCrcTable();
+
+uint32_t updateCrc(uint32_t crc, const uint8_t* data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        crc = kCrcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+void putUint32(uint8_t* out, uint32_t value) {
+    out[0] = static_cast<uint8_t>(value >> 24);
+    out[1] = static_cast<uint8_t>(value >> 16);
+    out[2] = static_cast<uint8_t>(value >> 8);
+    out[3] = static_cast<uint8_t>(value);
+}
+
+uint8_t paethPredictor(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = std::abs(p - a);
+    int pb = std::abs(p - b);
+    int pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) {
+        return static_cast<uint8_t>(a);
+    }
+    return static_cast<uint8_t>(pb <= pc ? b : c);
+}
+
+// 逐行写入 PNG，IDAT 数据攒到 32KB 输出一块
+class PngWriter {
+public:
+    PngWriter(uint32_t width, uint32_t height, uint32_t channels, const ByteSink& sink)
+        : sink_(sink),
+          channels_(channels),
+          rowSize_(static_cast<size_t>(width) * channels),
+          previous_(rowSize_, 0),
+          filtered_(rowSize_ + 1),
+          candidate_(rowSize_ + 1),
+          deflater_([this](const uint8_t* data, size_t size) { appendIdat(data, size); }) {
+        static const uint8_t kSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        sink_(kSignature, sizeof(kSignature));
+
+        uint8_t header[13];
+        putUint32(header, width);
+        putUint32(header + 4, height);
+        header[8] = 8;                          // 位深
+        header[9] = channels == 4 ? 6 : 2;      // 6 = RGBA，2 = RGB
+        header[10] = 0;                         // deflate
+        header[11] = 0;                         // 自适应滤波
+        header[12] = 0;                         // 不交错
+        writeChunk("IHDR", header, sizeof(header));
+    }
+
+    void writeRow(const uint8_t* row) {
+        // 依次尝试五种滤波，选择差值绝对值之和最小的一种
+        uint64_t bestScore = UINT64_MAX;
+        for (uint8_t filter = 0; filter <= 4; ++filter) {
+            candidate_[0] = filter;
+            uint64_t score = 0;
+            for (size_t i = 0; i < rowSize_; ++i) {
+                int left = i >= channels_ ? row[i - channels_] : 0;
+                int up = previous_[i];
+                int upLeft = i >= channels_ ? previous_[i - channels_] : 0;
+                int predicted = 0;
+                switch (filter) {
+                    case 1: predicted = left; break;
+                    case 2: predicted = up; break;
+                    case 3: predicted = (left + up) / 2; break;
+                    case 4: predicted = paethPredictor(left, up, upLeft); break;
+                    default: break;
+                }
+                uint8_t value = static_cast<uint8_t>(row[i] - predicted);
+                candidate_[i + 1] = value;
+                score += value < 128 ? value : 256 - value;
+            }
+            if (score < bestScore) {
+                bestScore = score;
+                filtered_.swap(candidate_);
+            }
+        }
+        deflater_.write(filtered_.data(), filtered_.size());
+        std::copy(row, row + rowSize_, previous_.begin());
+    }
+
+    void finish() {
+        deflater_.finish();
+        if (!idat_.empty()) {
+            writeChunk("IDAT", idat_.data(), idat_.size());
+            idat_.clear();
+        }
+        writeChunk("IEND", nullptr, 0);
+    }
+
+private:
+    static constexpr size_t kIdatSize = 32768;
+
+    void appendIdat(const uint8_t* data, size_t size) {
+        idat_.insert(idat_.end(), data, data + size);
+        if (idat_.size() >= kIdatSize) {
+            writeChunk("IDAT", idat_.data(), idat_.size());
+            idat_.clear();
+        }
+    }
+
+    void writeChunk(const char* type, const uint8_t* data, size_t size) {
+        uint8_t header[8];
+        putUint32(header, static_cast<uint32_t>(size));
+        std::copy(type, type + 4, header + 4);
+        sink_(header, sizeof(header));
+        if (size > 0) {
+            sink_(data, size);
+        }
+
+        uint32_t crc = updateCrc(0xFFFFFFFFu, header + 4, 4);
+        crc = updateCrc(crc, data, size) ^ 0xFFFFFFFFu;
+        uint8_t trailer[4];
+        putUint32(trailer, crc);
+        sink_(trailer, sizeof(trailer));
+    }
+
+    const ByteSink& sink_;
+    size_t channels_;
+    size_t rowSize_;
+    std::vector<uint8_t> previous_;
+    std::vector<uint8_t> filtered_;
+    std::vector<uint8_t> candidate_;
+    std::vector<uint8_t> idat_;
+    Deflater deflater_;
+};
+
+// ---------------------------------------------------------------------------
+// BMP 输入
+// ---------------------------------------------------------------------------
+
+struct BmpLayout {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    size_t pixelOffset = 0;
+    size_t stride = 0;
+    size_t bytesPerPixel = 0;
+    bool bottomUp = true;
+};
+
+uint32_t readUint32(const std::vector<uint8_t>& data, size_t pos) {
+    return static_cast<uint32_t>(data[pos]) | (static_cast<uint32_t>(data[pos + 1]) << 8) |
+           (static_cast<uint32_t>(data[pos + 2]) << 16) | (static_cast<uint32_t>(data[pos + 3]) << 24);
+}
+
+bool parseBmp(const std::vector<uint8_t>& data, BmpLayout& layout) {
+    if (data.size() < 54 || data[0] != 'B' || data[1] != 'M') {
+        return false;
+    }
+    uint32_t dibSize = readUint32(data, 14);
+    int32_t width = static_cast<int32_t>(readUint32(data, 18));
+    int32_t height = static_cast<int32_t>(readUint32(data, 22));
+    uint16_t planes = static_cast<uint16_t>(data[26] | (data[27] << 8));
+    uint16_t bitsPerPixel = static_cast<uint16_t>(data[28] | (data[29] << 8));
+    uint32_t compression = readUint32(data, 30);
+    if (dibSize < 40 || planes != 1 || compression != 0 ||
+        (bitsPerPixel != 24 && bitsPerPixel != 32) ||
+        width <= 0 || height == 0 || height == INT32_MIN) {
+        return false;
+    }
+
+    layout.width = static_cast<uint32_t>(width);
+    layout.height = static_cast<uint32_t>(height < 0 ? -height : height);
+    layout.bottomUp = height > 0;
+    layout.bytesPerPixel = bitsPerPixel / 8;
+    layout.stride = (static_cast<uint64_t>(layout.width) * bitsPerPixel + 31) / 32 * 4;
+    layout.pixelOffset = readUint32(data, 10);
+    if (layout.pixelOffset > data.size()) {
+        return false;
+    }
+    // 行数据必须完整
+    return layout.stride * layout.height <= data.size() - layout.pixelOffset;
+}
+
+// 分片输出：编码数据直接写入按 maxChunkSize 切好的分片
+class ChunkWriter {
+public:
+    // 新分片最多预留的字节数；maxChunkSize 很大（例如 SIZE_MAX 表示不分片）时按需增长
+    static constexpr size_t kMaxChunkReserve = 64 * 1024;
+
+    explicit ChunkWriter(size_t maxChunkSize) : maxChunkSize_(maxChunkSize) {}
+
+    void append(const uint8_t* data, size_t size) {
+        totalSize_ += size;
+        while (size > 0) {
+            if (chunks_.empty() || chunks_.back().size() == maxChunkSize_) {
+                chunks_.emplace_back();
+                chunks_.back().reserve(std::min(maxChunkSize_, kMaxChunkReserve));
+            }
+            auto& chunk = chunks_.back();
+            size_t count = std::min(size, maxChunkSize_ - chunk.size());
+            chunk.insert(chunk.end(), data, data + count);
+            data += count;
+            size -= count;
+        }
+    }
+
+    size_t totalSize() const { return totalSize_; }
+
+    std::vector<RichLogBlock> toBlocks(const std::string& type, const std::string& uuid) {
+        if (chunks_.empty()) {
+            chunks_.emplace_back();
+        }
+        std::vector<RichLogBlock> blocks;
+        blocks.reserve(chunks_.size());
+        uint32_t total = static_cast<uint32_t>(chunks_.size());
+        for (size_t i = 0; i < chunks_.size(); ++i) {
+            blocks.emplace_back(type, uuid, static_cast<uint32_t>(i + 1), total);
+            blocks.back().data = std::move(chunks_[i]);
+        }
+        chunks_.clear();
+        return blocks;
+    }
+
+private:
+    size_t maxChunkSize_;
+    size_t totalSize_ = 0;
+    std::vector<std::vector<uint8_t>> chunks_;
+};
+
+std::vector<RichLogBlock> chunkRaw(const std::string& type, const std::string& uuid,
+                                   const std::vector<uint8_t>& data, size_t maxChunkSize) {
+    ChunkWriter writer(maxChunkSize);
+    writer.append(data.data(), data.size());
+    return writer.toBlocks(type, uuid);
+}
+
+template <typename T>
+std::future<T> readyFuture(T value) {
+    std::promise<T> promise;
+    promise.set_value(std::move(value));
+    return promise.get_future();
+}
+
+} // namespace
+
+bool isBmpImage(const std::vector<uint8_t>& data) {
+    BmpLayout layout;
+    return parseBmp(data, layout);
+}
+
+bool transcodeBmpToPng(const std::vector<uint8_t>& bmp, const ByteSink& sink) {
+    BmpLayout layout;
+    if (!parseBmp(bmp, layout)) {
+        return false;
+    }
+
+    PngWriter writer(layout.width, layout.height, 3, sink);
+    std::vector<uint8_t> row(static_cast<size_t>(layout.width) * 3);
+    for (uint32_t y = 0; y < layout.height; ++y) {
+        uint32_t sourceRow = layout.bottomUp ? layout.height - 1 - y : y;
+        const uint8_t* source = bmp.data() + layout.pixelOffset + sourceRow * layout.stride;
+        // BMP 像素为 BGR(A)，32 位 BI_RGB 的第四字节不表示透明度
+        for (uint32_t x = 0; x < layout.width; ++x) {
+            const uint8_t* pixel = source + x * layout.bytesPerPixel;
+            row[x * 3] = pixel[2];
+            row[x * 3 + 1] = pixel[1];
+            row[x * 3 + 2] = pixel[0];
+        }
+        writer.writeRow(row.data());
+    }
+    writer.finish();
+    return true;
+}
+
+bool encodePng(const RawImage& image, const ByteSink& sink) {
+    if (image.width == 0 || image.height == 0 || (image.channels != 3 && image.channels != 4)) {
+        return false;
+    }
+    size_t rowSize = static_cast<size_t>(image.width) * image.channels;
+    if (image.pixels.size() != rowSize * image.height) {
+        return false;
+    }
+
+    PngWriter writer(image.width, image.height, image.channels, sink);
+    for (uint32_t y = 0; y < image.height; ++y) {
+        writer.writeRow(image.pixels.data() + y * rowSize);
+    }
+    writer.finish();
+    return true;
+}
+
+// ImageTranscodeStage 实现
+ImageTranscodeStage::ImageTranscodeStage(RichLogEncoder& encoder, ThreadPool& pool)
+    : encoder_(encoder), pool_(pool) {}
+
+std::future<std::vector<RichLogBlock>> ImageTranscodeStage::encode(const std::string& type,
+                                                                   std::vector<uint8_t> data,
+                                                                   size_t maxChunkSize) {
+    if (!isBmpImage(data)) {
+        return readyFuture(encoder_.encode(type, data, maxChunkSize));
+    }
+
+    // uuid 在调用线程生成，工作线程不访问 encoder；PNG 比原始数据大时回退为原始分片，
+    // 载荷大小不超过 data.size()
+    std::string uuid = encoder_.generateUUID();
+    maxChunkSize = encoder_.chunkSizeFor(type, uuid.size(), data.size(), maxChunkSize);
+    return pool_.submit([type, uuid, data = std::move(data), maxChunkSize]() {
+        ChunkWriter writer(maxChunkSize);
+        transcodeBmpToPng(data, [&writer](const uint8_t* bytes, size_t size) {
+            writer.append(bytes, size);
+        });
+        if (writer.totalSize() >= data.size()) {
+            return chunkRaw(type, uuid, data, maxChunkSize);
+        }
+        return writer.toBlocks(type, uuid);
+    });
+}
+
+std::future<std::vector<RichLogBlock>> ImageTranscodeStage::encodeFrame(const std::string& type,
+                                                                        RawImage frame,
+                                                                        size_t maxChunkSize) {
+    std::string uuid = encoder_.generateUUID();
+    // 固定霍夫曼编码最坏膨胀约 9/8，加上每行的过滤字节，取两倍原始大小作为上界
+    size_t sizeBound = 2 * (frame.pixels.size() + frame.height) + 1024;
+    maxChunkSize = encoder_.chunkSizeFor(type, uuid.size(), sizeBound, maxChunkSize);
+    return pool_.submit([type, uuid, frame = std::move(frame), maxChunkSize]() {
+        ChunkWriter writer(maxChunkSize);
+        bool encoded = encodePng(frame, [&writer](const uint8_t* bytes, size_t size) {
+            writer.append(bytes, size);
+        });
+        if (!encoded) {
+            throw std::invalid_argument("invalid raw image frame");
+        }
+        return writer.toBlocks(type, uuid);
+    });
+}
+
+} // namespace richlog
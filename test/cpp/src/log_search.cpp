@@ -0,0 +1,345 @@
+#include "log_search.hpp"
+#include "scanner.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// WebAssembly SIMD（emcc -msimd128）优先于 SSE2，逻辑逐条对应
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#define RICHLOG_SEARCH_WASM_SIMD 1
+#define RICHLOG_SEARCH_SSE2 0
+#elif defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+#include <emmintrin.h>
+#define RICHLOG_SEARCH_WASM_SIMD 0
+#define RICHLOG_SEARCH_SSE2 1
+#else
+#define RICHLOG_SEARCH_WASM_SIMD 0
+#define RICHLOG_SEARCH_SSE2 0
+#endif
+
+namespace richlog {
+
+namespace {
+
+#if RICHLOG_SEARCH_WASM_SIMD
+// 16 个位置中 head[k] == first 且 tail[k] == last 的位置掩码
+unsigned matchMask(const char* head, const char* tail, char first, char last) {
+    v128_t hits = wasm_v128_and(wasm_i8x16_eq(wasm_v128_load(head), wasm_i8x16_splat(first)),
+                                wasm_i8x16_eq(wasm_v128_load(tail), wasm_i8x16_splat(last)));
+    return static_cast<unsigned>(wasm_i8x16_bitmask(hits));
+}
+#elif RICHLOG_SEARCH_SSE2
+unsigned matchMask(const char* head, const char* tail, char first, char last) {
+    __m128i hits = _mm_and_si128(
+        _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(head)), _mm_set1_epi8(first)),
+        _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tail)), _mm_set1_epi8(last)));
+    return static_cast<unsigned>(_mm_movemask_epi8(hits));
+}
+#endif
+
+// 在 [data, data + size) 中查找 needle，返回偏移，找不到时返回 size
+//
+// 向量版本一次比较 16 个位置的首字节和末字节，两者都相同的位置才比较中间部分，
+// 对日志中常见的短字面量比逐字节匹配快得多。
+size_t findLiteral(const char* data, size_t size, const std::string& needle) {
+    const size_t length = needle.size();
+    if (length > size) {
+        return size;
+    }
+#if RICHLOG_SEARCH_WASM_SIMD || RICHLOG_SEARCH_SSE2
+    size_t i = 0;
+    for (; i + length - 1 + 16 <= size; i += 16) {
+        unsigned mask = matchMask(data + i, data + i + length - 1, needle[0], needle[length - 1]);
+        while (mask != 0) {
+            size_t candidate = i + static_cast<size_t>(__builtin_ctz(mask));
+            if (length <= 2 || std::memcmp(data + candidate + 1, needle.data() + 1, length - 2) == 0) {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+    }
+    for (; i + length <= size; ++i) {
+        if (std::memcmp(data + i, needle.data(), length) == 0) {
+            return i;
+        }
+    }
+    return size;
+#elif defined(__GLIBC__)
+    const void* hit = memmem(data, size, needle.data(), length);
+    return hit ? static_cast<size_t>(static_cast<const char*>(hit) - data) : size;
+#else
+    const char* hit = std::search(data, data + size, needle.begin(), needle.end());
+    return hit == data + size ? size : static_cast<size_t>(hit - data);
+#endif
+}
+
+// 统计换行符数量，向量版本用 8 位计数器累加，每 255 个块汇总一次
+size_t countNewlines(const char* data, size_t size) {
+    size_t count = 0;
+    size_t i = 0;
+#if RICHLOG_SEARCH_WASM_SIMD
+    const v128_t newline = wasm_i8x16_splat('\n');
+    while (i + 16 <= size) {
+        size_t blocks = std::min<size_t>((size - i) / 16, 255);
+        v128_t counters = wasm_i8x16_splat(0);
+        for (size_t block = 0; block < blocks; ++block, i += 16) {
+            v128_t chunk = wasm_v128_load(data + i);
+            counters = wasm_i8x16_sub(counters, wasm_i8x16_eq(chunk, newline));
+        }
+        v128_t sums = wasm_u32x4_extadd_pairwise_u16x8(wasm_u16x8_extadd_pairwise_u8x16(counters));
+        count += static_cast<size_t>(wasm_u32x4_extract_lane(sums, 0)) + wasm_u32x4_extract_lane(sums, 1) +
+                 wasm_u32x4_extract_lane(sums, 2) + wasm_u32x4_extract_lane(sums, 3);
+    }
+#elif RICHLOG_SEARCH_SSE2
+    const __m128i newline = _mm_set1_epi8('\n');
+    while (i + 16 <= size) {
+        size_t blocks = std::min<size_t>((size - i) / 16, 255);
+        __m128i counters = _mm_setzero_si128();
+        for (size_t block = 0; block < blocks; ++block, i += 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            counters = _mm_sub_epi8(counters, _mm_cmpeq_epi8(chunk, newline));
+        }
+        __m128i sums = _mm_sad_epu8(counters, _mm_setzero_si128());
+        count += static_cast<size_t>(_mm_cvtsi128_si32(sums)) + static_cast<size_t>(_mm_extract_epi16(sums, 4));
+    }
+#endif
+    for (; i < size; ++i) {
+        count += data[i] == '\n';
+    }
+    return count;
+}
+
+// 反向查找换行符，返回其位置，找不到时返回 nullptr
+const void* findLastNewline(const char* data, size_t size) {
+#if defined(__GLIBC__)
+    return memrchr(data, '\n', size);
+#else
+    for (size_t i = size; i > 0; --i) {
+        if (data[i - 1] == '\n') {
+            return data + i - 1;
+        }
+    }
+    return nullptr;
+#endif
+}
+
+} // namespace
+
+// MappedFile 实现
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+#if !defined(_WIN32)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+    size_ = static_cast<size_t>(info.st_size);
+    if (size_ == 0) {
+        ::close(fd);
+        return true;
+    }
+    void* address = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        size_ = 0;
+        return false;
+    }
+    madvise(address, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const char*>(address);
+    mapped_ = true;
+    return true;
+#else
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    buffer_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+    return true;
+#endif
+}
+
+void MappedFile::close() {
+#if !defined(_WIN32)
+    if (mapped_) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    mapped_ = false;
+    buffer_.clear();
+}
+
+// LogSearcher 实现
+LogSearcher::LogSearcher(SearchQuery query) : query_(std::move(query)) {
+    for (const auto& literal : query_.literals) {
+        if (literal.find('\n') != std::string::npos) {
+            throw std::invalid_argument("search literal must not contain a newline");
+        }
+    }
+    // 空字面量匹配所有行，等同于不限内容
+    if (std::any_of(query_.literals.begin(), query_.literals.end(),
+                    [](const std::string& literal) { return literal.empty(); })) {
+        query_.literals.clear();
+    }
+    if (!query_.type.empty() || !query_.uuid.empty()) {
+        query_.richlogOnly = true;
+    }
+
+    // 选择定位字面量：优先使用搜索文本，其次 uuid、类型，最后是 RICHLOG 标记
+    if (!query_.literals.empty()) {
+        anchors_ = query_.literals;
+        literalAnchors_ = true;
+    } else if (!query_.uuid.empty()) {
+        anchors_.push_back(query_.uuid);
+    } else if (!query_.type.empty()) {
+        anchors_.push_back("RICHLOG:" + query_.type + ",");
+    } else if (query_.richlogOnly) {
+        anchors_.push_back("RICHLOG:");
+    } else {
+        matchAll_ = true;
+    }
+}
+
+bool LogSearcher::matchesLine(std::string_view line) const {
+    if (!query_.literals.empty() &&
+        std::none_of(query_.literals.begin(), query_.literals.end(),
+                     [line](const std::string& literal) { return line.find(literal) != std::string_view::npos; })) {
+        return false;
+    }
+    return matchesRichLog(line);
+}
+
+bool LogSearcher::matchesRichLog(std::string_view line) const {
+    if (!query_.richlogOnly) {
+        return true;
+    }
+    RichLogLineView view;
+    if (!scanRichLogLine(line, view)) {
+        return false;
+    }
+    return (query_.type.empty() || view.type == query_.type) &&
+           (query_.uuid.empty() || view.uuid == query_.uuid);
+}
+
+void LogSearcher::searchRange(std::string_view text, size_t begin, size_t end, RangeResult& result) const {
+    const char* data = text.data();
+    size_t pos = begin;         // 始终位于行首
+    size_t lineIndex = 0;       // pos 所在行在区间内的序号
+
+    // anchorHit 为 true 时行内已确认包含某个搜索文本，只需校验 RICHLOG 条件
+    auto takeLine = [&](size_t lineStart, bool anchorHit) {
+        const char* newline = static_cast<const char*>(std::memchr(data + lineStart, '\n', end - lineStart));
+        size_t lineEnd = newline ? static_cast<size_t>(newline - data) : end;
+        lineIndex += countNewlines(data + pos, lineStart - pos);
+        std::string_view line(data + lineStart, lineEnd - lineStart);
+        bool matched = matchAll_ ||
+                       (anchorHit && literalAnchors_ ? matchesRichLog(line) : matchesLine(line));
+        if (matched) {
+            result.matches.push_back(SearchMatch{lineStart, lineIndex, line});
+        }
+        pos = newline ? lineEnd + 1 : end;
+        if (newline) {
+            ++lineIndex;
+        }
+    };
+
+    if (anchors_.empty()) {
+        while (pos < end) {
+            takeLine(pos, false);
+        }
+    } else {
+        // 每个字面量记录下一个命中位置，只有被越过时才重新查找
+        std::vector<size_t> nextHit(anchors_.size(), 0);
+        std::vector<bool> valid(anchors_.size(), false);
+        while (pos < end) {
+            size_t hit = end;
+            for (size_t i = 0; i < anchors_.size(); ++i) {
+                if (!valid[i] || nextHit[i] < pos) {
+                    nextHit[i] = pos + findLiteral(data + pos, end - pos, anchors_[i]);
+                    valid[i] = true;
+                }
+                hit = std::min(hit, nextHit[i]);
+            }
+            if (hit >= end) {
+                break;
+            }
+            // 命中位置所在行的行首
+            size_t lineStart = pos;
+            if (hit > pos) {
+                const void* newline = findLastNewline(data + pos, hit - pos);
+                if (newline) {
+                    lineStart = static_cast<size_t>(static_cast<const char*>(newline) - data) + 1;
+                }
+            }
+            takeLine(lineStart, true);
+        }
+    }
+
+    result.newlineCount = lineIndex + countNewlines(data + pos, end - pos);
+}
+
+std::vector<SearchMatch> LogSearcher::search(ThreadPool& pool, std::string_view text, size_t rangeSize) const {
+    // 按换行边界切分区间，每个区间以完整的行结束
+    rangeSize = std::max<size_t>(rangeSize, 1);
+    std::vector<size_t> bounds{0};
+    while (bounds.back() < text.size()) {
+        size_t next = bounds.back() + rangeSize;
+        if (next >= text.size()) {
+            next = text.size();
+        } else {
+            const void* newline = std::memchr(text.data() + next, '\n', text.size() - next);
+            next = newline ? static_cast<size_t>(static_cast<const char*>(newline) - text.data()) + 1
+                           : text.size();
+        }
+        bounds.push_back(next);
+    }
+
+    const size_t rangeCount = bounds.size() - 1;
+    std::vector<RangeResult> results(rangeCount);
+    pool.parallelFor(0, rangeCount, 1, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            searchRange(text, bounds[i], bounds[i + 1], results[i]);
+        }
+    });
+
+    // 合并结果并换算为全局行号
+    size_t total = 0;
+    for (const auto& result : results) {
+        total += result.matches.size();
+    }
+    std::vector<SearchMatch> matches;
+    matches.reserve(total);
+    size_t firstLine = 1;
+    for (auto& result : results) {
+        for (auto& match : result.matches) {
+            match.lineNumber += firstLine;
+            matches.push_back(match);
+        }
+        firstLine += result.newlineCount;
+    }
+    return matches;
+}
+
+} // namespace richlog
@@ -0,0 +1,454 @@
+#include "log_stats.hpp"
+#include "scanner.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <unordered_map>
+
+namespace richlog {
+
+namespace {
+
+// 第二阶段按 uuid 哈希划分的分片数
+constexpr size_t kShardCount = 64;
+
+// 总分片数超过该值的载荷不建位图，视为无效
+constexpr uint32_t kMaxTrackedChunks = 1u << 24;
+
+int countTrailingZeros(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(value);
+#else
+    int count = 0;
+    for (; (value & 1) == 0; value >>= 1) {
+        ++count;
+    }
+    return count;
+#endif
+}
+
+// 一个载荷在一个区间内（或合并若干区间后）的状态，字符串指向原始文本
+//
+// 分片字节数按“常见大小 + 末尾分片 + 例外”保存：合并区间时要知道每个新分片的
+// 字节数，而正常载荷除末尾分片外大小都相同，内存与载荷数而不是行数成正比。
+struct PayloadState {
+    std::string_view type;
+    uint64_t offset = 0;          // 第一个分片所在行的字节偏移
+    uint64_t bytes = 0;
+    uint32_t total = 0;
+    uint32_t received = 0;
+    bool invalid = false;
+    std::vector<uint64_t> seen;   // 已收到分片的位图，total > 1 时使用
+    bool hasCommonChunkBytes = false;
+    uint64_t commonChunkBytes = 0;                 // 第一个收到的非末尾分片的字节数
+    uint64_t lastChunkBytes = 0;                   // 末尾分片的字节数
+    std::map<uint32_t, uint64_t> otherChunkBytes;  // 与 commonChunkBytes 不同的非末尾分片
+
+    uint64_t chunkBytes(uint32_t index) const {
+        if (index == total) {
+            return lastChunkBytes;
+        }
+        auto it = otherChunkBytes.find(index);
+        return it == otherChunkBytes.end() ? commonChunkBytes : it->second;
+    }
+
+    // 登记一个新收到的分片
+    void addChunk(uint32_t index, uint64_t size) {
+        ++received;
+        bytes += size;
+        if (index == total) {
+            lastChunkBytes = size;
+        } else if (!hasCommonChunkBytes) {
+            hasCommonChunkBytes = true;
+            commonChunkBytes = size;
+        } else if (size != commonChunkBytes) {
+            otherChunkBytes.emplace(index, size);
+        }
+    }
+};
+
+using PayloadMap = std::unordered_map<std::string_view, PayloadState>;
+
+struct RangeResult {
+    std::array<PayloadMap, kShardCount> shards;            // 按 uuid 哈希分片的载荷状态
+    std::unordered_map<std::string_view, TypeStats> types; // 按行计数的字段：分片、引用、区间内的重复分片
+    uint64_t richlogLines = 0;
+    uint64_t invalidLines = 0;
+};
+
+// 按偏移保留最靠前的 limit 个样本
+void addSample(std::vector<PayloadSample>& samples, PayloadSample sample, size_t limit) {
+    if (samples.size() >= limit && (limit == 0 || sample.offset >= samples.back().offset)) {
+        return;
+    }
+    auto position = std::upper_bound(samples.begin(), samples.end(), sample.offset,
+                                     [](uint64_t offset, const PayloadSample& entry) { return offset < entry.offset; });
+    samples.insert(position, std::move(sample));
+    if (samples.size() > limit) {
+        samples.pop_back();
+    }
+}
+
+// 把一个分片行计入所在区间的载荷状态
+void addChunkLine(PayloadMap& payloads, const RichLogLineView& view, uint64_t offset, TypeStats& stats) {
+    auto [it, inserted] = payloads.try_emplace(view.uuid);
+    PayloadState& payload = it->second;
+    if (inserted) {
+        payload.type = view.type;
+        payload.offset = offset;
+        payload.total = view.total;
+        if (view.total > kMaxTrackedChunks) {
+            payload.invalid = true;
+        } else if (view.total > 1) {
+            payload.seen.assign((view.total + 63) / 64, 0);
+        }
+    }
+    if (view.type != payload.type || view.total != payload.total || view.index == 0 ||
+        view.index > payload.total) {
+        payload.invalid = true;
+        return;
+    }
+    if (payload.total > kMaxTrackedChunks) {
+        return;
+    }
+
+    bool duplicate;
+    if (payload.total == 1) {
+        duplicate = payload.received > 0;
+    } else {
+        uint64_t& word = payload.seen[(view.index - 1) / 64];
+        uint64_t bit = uint64_t(1) << ((view.index - 1) % 64);
+        duplicate = (word & bit) != 0;
+        word |= bit;
+    }
+    if (duplicate) {
+        ++stats.duplicateChunks;
+        return;
+    }
+    payload.addChunk(view.index, view.hex.size() / 2);
+}
+
+// 扫描 [begin, end) 内的 RICHLOG 行并当场汇总，begin 位于行首，end 位于行尾之后
+void scanRange(std::string_view text, size_t begin, size_t end, RangeResult& result) {
+    std::string_view range = text.substr(0, end);
+    std::hash<std::string_view> hasher;
+    size_t pos = begin;
+    while (pos < end) {
+        size_t marker = findRichLogMarker(range, pos);
+        if (marker == std::string_view::npos) {
+            break;
+        }
+        // pos 之前一个字符是换行符，向前查找不会越过 pos
+        size_t lineStart = pos;
+        size_t previous = range.rfind('\n', marker);
+        if (previous != std::string_view::npos && previous >= pos) {
+            lineStart = previous + 1;
+        }
+        size_t newline = range.find('\n', marker);
+        size_t lineEnd = newline == std::string_view::npos ? end : newline;
+        std::string_view line = range.substr(lineStart, lineEnd - lineStart);
+
+        RichLogLineView view;
+        if (scanRichLogLineSimd(line, view)) {
+            ++result.richlogLines;
+            TypeStats& stats = result.types[view.type];
+            ++stats.chunks;
+            stats.encodedBytes += line.size();
+            if (view.index == 0 && view.total == 0) {
+                ++stats.references;
+            } else {
+                addChunkLine(result.shards[hasher(view.uuid) % kShardCount], view, lineStart, stats);
+            }
+        } else {
+            ++result.invalidLines;
+        }
+        pos = lineEnd + 1;
+    }
+}
+
+// 把较晚区间中同一 uuid 的状态并入 into，跨区间的重复分片计入 stats
+//
+// 头部与 into 不一致时整个载荷无效。例外：较晚区间内与该区间第一行头部不一致、
+// 却与更早区间一致的行不计入 received，只影响已无效载荷样本中的收到分片数。
+void mergePayload(PayloadState& into, const PayloadState& later, TypeStats& stats) {
+    if (later.type != into.type || later.total != into.total) {
+        into.invalid = true;
+        return;
+    }
+    into.invalid = into.invalid || later.invalid;
+    if (into.total > kMaxTrackedChunks || later.received == 0) {
+        return;
+    }
+
+    if (into.total == 1) {
+        if (into.received > 0) {
+            ++stats.duplicateChunks;
+        } else {
+            into.addChunk(1, later.lastChunkBytes);
+        }
+        return;
+    }
+    for (size_t w = 0; w < later.seen.size(); ++w) {
+        uint64_t repeated = later.seen[w] & into.seen[w];
+        uint64_t fresh = later.seen[w] & ~into.seen[w];
+        for (; repeated != 0; repeated &= repeated - 1) {
+            ++stats.duplicateChunks;
+        }
+        into.seen[w] |= fresh;
+        for (; fresh != 0; fresh &= fresh - 1) {
+            uint32_t index = static_cast<uint32_t>(w * 64 + countTrailingZeros(fresh) + 1);
+            into.addChunk(index, later.chunkBytes(index));
+        }
+    }
+}
+
+// 按区间顺序合并一个分片中各区间的载荷状态，结果与单线程顺序扫描相同
+void mergeShard(std::vector<RangeResult>& ranges, size_t shard, size_t sampleLimit,
+                std::unordered_map<std::string_view, TypeStats>& types) {
+    PayloadMap payloads;
+    for (auto& range : ranges) {
+        for (auto& [uuid, state] : range.shards[shard]) {
+            auto [it, inserted] = payloads.try_emplace(uuid);
+            if (inserted) {
+                it->second = std::move(state);
+            } else {
+                mergePayload(it->second, state, types[it->second.type]);
+            }
+        }
+        PayloadMap().swap(range.shards[shard]);
+    }
+
+    for (const auto& [uuid, payload] : payloads) {
+        TypeStats& stats = types[payload.type];
+        ++stats.payloads;
+        stats.payloadBytes += payload.bytes;
+        if (!payload.invalid && payload.received == payload.total) {
+            ++stats.completePayloads;
+            stats.maxPayloadBytes = std::max(stats.maxPayloadBytes, payload.bytes);
+            stats.payloadSizes.add(payload.bytes);
+            stats.chunksPerPayload.add(payload.total);
+            continue;
+        }
+        if (payload.invalid) {
+            ++stats.invalidPayloads;
+        } else {
+            ++stats.incompletePayloads;
+        }
+        addSample(stats.samples,
+                  PayloadSample{std::string(uuid), payload.offset, payload.received, payload.total, payload.invalid},
+                  sampleLimit);
+    }
+}
+
+std::string indentation(size_t width) {
+    return std::string(width, ' ');
+}
+
+void appendJsonString(std::string& out, std::string_view value) {
+    static const char* hexChars = "0123456789abcdef";
+    out += '"';
+    for (char c : value) {
+        uint8_t byte = static_cast<uint8_t>(c);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (byte < 0x20) {
+            out += "\\u00";
+            out += hexChars[byte >> 4];
+            out += hexChars[byte & 0x0F];
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+void appendField(std::string& out, const std::string& indent, const char* name, uint64_t value) {
+    out += indent;
+    out += '"';
+    out += name;
+    out += "\": ";
+    out += std::to_string(value);
+    out += ",\n";
+}
+
+void appendRate(std::string& out, const std::string& indent, const char* name, uint64_t count, uint64_t total) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.6f", total == 0 ? 0.0 : static_cast<double>(count) / total);
+    out += indent;
+    out += '"';
+    out += name;
+    out += "\": ";
+    out += buffer;
+    out += ",\n";
+}
+
+// 只输出非空的桶，每个桶一行
+void appendHistogram(std::string& out, const std::string& indent, const PowerOfTwoHistogram& histogram) {
+    std::string entries;
+    for (size_t k = 0; k < histogram.buckets.size(); ++k) {
+        if (histogram.buckets[k] == 0) {
+            continue;
+        }
+        uint64_t min = k == 0 ? 0 : uint64_t(1) << (k - 1);
+        uint64_t max = k == 0 ? 0 : (k == 64 ? UINT64_MAX : (uint64_t(1) << k) - 1);
+        entries += entries.empty() ? "\n" : ",\n";
+        entries += indent + "  {\"min\": " + std::to_string(min) + ", \"max\": " + std::to_string(max) +
+                   ", \"count\": " + std::to_string(histogram.buckets[k]) + "}";
+    }
+    out += entries.empty() ? "[]" : "[" + entries + "\n" + indent + "]";
+}
+
+void appendTypeStats(std::string& out, const TypeStats& stats, size_t indent) {
+    std::string inner = indentation(indent + 2);
+    out += "{\n";
+    appendField(out, inner, "payloads", stats.payloads);
+    appendField(out, inner, "completePayloads", stats.completePayloads);
+    appendField(out, inner, "incompletePayloads", stats.incompletePayloads);
+    appendField(out, inner, "invalidPayloads", stats.invalidPayloads);
+    appendRate(out, inner, "incompleteRate", stats.incompletePayloads, stats.payloads);
+    appendRate(out, inner, "invalidRate", stats.invalidPayloads, stats.payloads);
+    appendField(out, inner, "references", stats.references);
+    appendField(out, inner, "chunks", stats.chunks);
+    appendField(out, inner, "duplicateChunks", stats.duplicateChunks);
+    appendField(out, inner, "payloadBytes", stats.payloadBytes);
+    appendField(out, inner, "encodedBytes", stats.encodedBytes);
+    appendField(out, inner, "maxPayloadBytes", stats.maxPayloadBytes);
+
+    out += inner + "\"payloadSizes\": ";
+    appendHistogram(out, inner, stats.payloadSizes);
+    out += ",\n" + inner + "\"chunksPerPayload\": ";
+    appendHistogram(out, inner, stats.chunksPerPayload);
+
+    out += ",\n" + inner + "\"samples\": [";
+    for (size_t i = 0; i < stats.samples.size(); ++i) {
+        const auto& sample = stats.samples[i];
+        out += i == 0 ? "\n" : ",\n";
+        out += inner + "  {\"uuid\": ";
+        appendJsonString(out, sample.uuid);
+        out += ", \"offset\": " + std::to_string(sample.offset) + ", \"received\": " +
+               std::to_string(sample.received) + ", \"total\": " + std::to_string(sample.total) +
+               ", \"reason\": \"" + (sample.invalid ? "invalid" : "incomplete") + "\"}";
+    }
+    out += stats.samples.empty() ? "]\n" : "\n" + inner + "]\n";
+    out += indentation(indent) + "}";
+}
+
+} // namespace
+
+// PowerOfTwoHistogram 实现
+void PowerOfTwoHistogram::add(uint64_t value) {
+    size_t bucket = 0;
+    while (value != 0) {
+        ++bucket;
+        value >>= 1;
+    }
+    ++buckets[bucket];
+}
+
+void PowerOfTwoHistogram::merge(const PowerOfTwoHistogram& other) {
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        buckets[i] += other.buckets[i];
+    }
+}
+
+// TypeStats 实现
+void TypeStats::merge(const TypeStats& other, size_t sampleLimit) {
+    payloads += other.payloads;
+    completePayloads += other.completePayloads;
+    incompletePayloads += other.incompletePayloads;
+    invalidPayloads += other.invalidPayloads;
+    references += other.references;
+    chunks += other.chunks;
+    duplicateChunks += other.duplicateChunks;
+    payloadBytes += other.payloadBytes;
+    encodedBytes += other.encodedBytes;
+    maxPayloadBytes = std::max(maxPayloadBytes, other.maxPayloadBytes);
+    payloadSizes.merge(other.payloadSizes);
+    chunksPerPayload.merge(other.chunksPerPayload);
+    for (const auto& sample : other.samples) {
+        addSample(samples, sample, sampleLimit);
+    }
+}
+
+// LogStatsCollector 实现
+LogStatsCollector::LogStatsCollector(size_t sampleLimit) : sampleLimit_(sampleLimit) {}
+
+LogStats LogStatsCollector::collect(ThreadPool& pool, std::string_view text, size_t rangeSize) const {
+    // 按换行边界切分区间，每个区间以完整的行结束
+    rangeSize = std::max<size_t>(rangeSize, 1);
+    std::vector<size_t> bounds{0};
+    while (bounds.back() < text.size()) {
+        size_t next = bounds.back() + rangeSize;
+        if (next >= text.size()) {
+            next = text.size();
+        } else {
+            const void* newline = std::memchr(text.data() + next, '\n', text.size() - next);
+            next = newline ? static_cast<size_t>(static_cast<const char*>(newline) - text.data()) + 1
+                           : text.size();
+        }
+        bounds.push_back(next);
+    }
+
+    const size_t rangeCount = bounds.size() - 1;
+    std::vector<RangeResult> ranges(rangeCount);
+    pool.parallelFor(0, rangeCount, 1, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            scanRange(text, bounds[i], bounds[i + 1], ranges[i]);
+        }
+    });
+
+    std::vector<std::unordered_map<std::string_view, TypeStats>> shards(kShardCount);
+    pool.parallelFor(0, kShardCount, 1, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            mergeShard(ranges, i, sampleLimit_, shards[i]);
+        }
+    });
+
+    LogStats stats;
+    stats.bytes = text.size();
+    for (const auto& range : ranges) {
+        stats.richlogLines += range.richlogLines;
+        stats.invalidLines += range.invalidLines;
+        for (const auto& [type, typeStats] : range.types) {
+            stats.types[std::string(type)].merge(typeStats, sampleLimit_);
+        }
+    }
+    for (const auto& shard : shards) {
+        for (const auto& [type, typeStats] : shard) {
+            stats.types[std::string(type)].merge(typeStats, sampleLimit_);
+        }
+    }
+    for (const auto& entry : stats.types) {
+        stats.total.merge(entry.second, sampleLimit_);
+    }
+    return stats;
+}
+
+std::string formatLogStatsJson(const LogStats& stats, const std::string& path) {
+    std::string out = "{\n";
+    out += "  \"path\": ";
+    appendJsonString(out, path);
+    out += ",\n";
+    appendField(out, "  ", "bytes", stats.bytes);
+    appendField(out, "  ", "richlogLines", stats.richlogLines);
+    appendField(out, "  ", "invalidLines", stats.invalidLines);
+    appendRate(out, "  ", "invalidLineRate", stats.invalidLines, stats.richlogLines + stats.invalidLines);
+    out += "  \"total\": ";
+    appendTypeStats(out, stats.total, 2);
+    out += ",\n  \"types\": {";
+    bool first = true;
+    for (const auto& [type, typeStats] : stats.types) {
+        out += first ? "\n    " : ",\n    ";
+        first = false;
+        appendJsonString(out, type);
+        out += ": ";
+        appendTypeStats(out, typeStats, 4);
+    }
+    out += stats.types.empty() ? "}\n}" : "\n  }\n}";
+    return out;
+}
+
+} // namespace richlog
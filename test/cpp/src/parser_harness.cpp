@@ -0,0 +1,231 @@
+#include "parser_harness.hpp"
+#include "scanner.hpp"
+#include <chrono>
+#include <random>
+
+namespace richlog {
+
+namespace {
+
+bool sameBlock(const RichLogBlock* a, const RichLogBlock* b) {
+    if (!a || !b) {
+        return a == b;
+    }
+    return a->type == b->type && a->uuid == b->uuid && a->index == b->index && a->total == b->total &&
+           a->data == b->data;
+}
+
+void appendJsonString(std::string& out, const std::string& text) {
+    static const char* hexChars = "0123456789abcdef";
+    out += '"';
+    for (char c : text) {
+        uint8_t byte = static_cast<uint8_t>(c);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (byte < 0x20 || byte >= 0x7f) {
+            out += "\\u00";
+            out += hexChars[byte >> 4];
+            out += hexChars[byte & 0x0F];
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+// 变异时插入的字符，偏向会影响匹配边界的字符
+const std::string kMutationAlphabet = std::string(",:R0189aAfFgG \t\r") + std::string(1, '\0') + "\x80\xff";
+
+const char* const kTypes[] = {"config", "image", "command", "RICHLOG:", "a b", "\xe5\x9b\xbe"};
+
+const char* const kNumbers[] = {"0", "1", "00012", "4294967295", "4294967296", "99999999999999999999999"};
+
+std::string randomHex(std::mt19937& rng, size_t length) {
+    static const char* hexChars = "0123456789abcdefABCDEF";
+    std::string hex;
+    for (size_t i = 0; i < length; ++i) {
+        hex += hexChars[rng() % 22];
+    }
+    return hex;
+}
+
+std::string randomRichLogLine(std::mt19937& rng) {
+    std::string line = "[2023-08-15 10:00:0" + std::to_string(rng() % 10) + ".236] ";
+    if (rng() % 4 == 0) {
+        line += "INFO: prefix ";
+    }
+    uint32_t total = 1 + rng() % 20;
+    line += "RICHLOG:";
+    size_t typeCount = rng() % 4 == 0 ? 6 : 3;
+    line += kTypes[rng() % typeCount];
+    line += ',';
+    line += randomHex(rng, 8);
+    line += ',';
+    line += std::to_string(1 + rng() % total);
+    line += ',';
+    line += std::to_string(total);
+    line += ',';
+    // 长度覆盖 SIMD 整块与尾部处理，包含奇数长度
+    line += randomHex(rng, rng() % 3 == 0 ? rng() % 200 : rng() % 40);
+    if (rng() % 3 == 0) {
+        line += rng() % 2 ? " trailing text" : "\r";
+    }
+    return line;
+}
+
+void mutate(std::mt19937& rng, std::string& line) {
+    size_t position = line.empty() ? 0 : rng() % (line.size() + 1);
+    switch (rng() % 6) {
+        case 0:   // 替换一个字符
+            if (position < line.size()) {
+                line[position] = kMutationAlphabet[rng() % kMutationAlphabet.size()];
+            }
+            break;
+        case 1:   // 插入一个字符
+            line.insert(position, 1, kMutationAlphabet[rng() % kMutationAlphabet.size()]);
+            break;
+        case 2:   // 插入标记
+            line.insert(position, "RICHLOG:");
+            break;
+        case 3:   // 截断
+            line.resize(position);
+            break;
+        case 4: { // 把一个数字字段换成边界值
+            size_t comma = line.find(',', position);
+            if (comma != std::string::npos) {
+                line.insert(comma + 1, std::string(kNumbers[rng() % 6]) + ",");
+            }
+            break;
+        }
+        default:  // 复制一段
+            if (position < line.size()) {
+                line.insert(position, line.substr(position, rng() % 24));
+            }
+            break;
+    }
+}
+
+} // namespace
+
+std::vector<ParserImplementation> makeParserImplementations() {
+    std::vector<ParserImplementation> implementations;
+    implementations.push_back({"reference", std::make_unique<RichLogParser>()});
+    implementations.push_back({"fast", std::make_unique<FastRichLogParser>()});
+    implementations.push_back({"simd", std::make_unique<SimdRichLogParser>()});
+    return implementations;
+}
+
+std::string describeParseResult(const RichLogBlock* block) {
+    if (!block) {
+        return "null";
+    }
+    std::string out = "{\"type\":";
+    appendJsonString(out, block->type);
+    out += ",\"uuid\":";
+    appendJsonString(out, block->uuid);
+    out += ",\"index\":" + std::to_string(block->index);
+    out += ",\"total\":" + std::to_string(block->total);
+    out += ",\"data\":\"";
+    appendHex(out, block->data.data(), block->data.size());
+    out += "\"}";
+    return out;
+}
+
+// ParserDiffHarness 实现
+ParserDiffHarness::ParserDiffHarness() : implementations_(makeParserImplementations()) {}
+
+bool ParserDiffHarness::compare(const std::string& line, std::vector<std::string>* results) {
+    std::vector<std::unique_ptr<RichLogBlock>> blocks;
+    for (auto& implementation : implementations_) {
+        blocks.push_back(implementation.parser->parse(line));
+    }
+
+    bool same = true;
+    for (size_t i = 1; i < blocks.size(); ++i) {
+        same = same && sameBlock(blocks[0].get(), blocks[i].get());
+    }
+    if (results) {
+        results->clear();
+        for (const auto& block : blocks) {
+            results->push_back(describeParseResult(block.get()));
+        }
+    }
+    return same;
+}
+
+ParserDiffReport ParserDiffHarness::run(const std::vector<std::string>& lines, size_t maxDivergences) {
+    ParserDiffReport report;
+    report.lines = lines.size();
+    for (const auto& line : lines) {
+        report.bytes += line.size() + 1;
+    }
+
+    // 每个实现独立跑完全部输入，计时不受其他实现的缓存影响
+    std::vector<std::vector<std::unique_ptr<RichLogBlock>>> results(implementations_.size());
+    for (size_t i = 0; i < implementations_.size(); ++i) {
+        ParserThroughput throughput;
+        throughput.name = implementations_[i].name;
+        results[i].reserve(lines.size());
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& line : lines) {
+            results[i].push_back(implementations_[i].parser->parse(line));
+        }
+        throughput.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        for (const auto& block : results[i]) {
+            throughput.matched += block != nullptr;
+        }
+        report.throughput.push_back(throughput);
+    }
+
+    for (size_t line = 0; line < lines.size(); ++line) {
+        bool same = true;
+        for (size_t i = 1; i < results.size(); ++i) {
+            same = same && sameBlock(results[0][line].get(), results[i][line].get());
+        }
+        if (same) {
+            continue;
+        }
+        if (report.divergences.size() < maxDivergences) {
+            ParserDivergence divergence;
+            divergence.line = line;
+            divergence.input = lines[line];
+            for (const auto& result : results) {
+                divergence.results.push_back(describeParseResult(result[line].get()));
+            }
+            report.divergences.push_back(std::move(divergence));
+        }
+        ++report.divergenceCount;
+    }
+    return report;
+}
+
+std::vector<std::string> generateParserCorpus(size_t count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<std::string> lines;
+    lines.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        std::string line;
+        switch (rng() % 8) {
+            case 0:
+                line = "[2023-08-15 10:00:01.236] INFO: User login successful";
+                break;
+            case 1:
+                line = "[2023-08-15 10:00:01.236] DEBUG: RICHLOG is disabled, 42 lines, ff";
+                break;
+            default:
+                line = randomRichLogLine(rng);
+                break;
+        }
+        // 约一半的行做一到三次变异
+        if (rng() % 2 == 0) {
+            for (uint32_t round = 0, rounds = 1 + rng() % 3; round < rounds; ++round) {
+                mutate(rng, line);
+            }
+        }
+        lines.push_back(std::move(line));
+    }
+    return lines;
+}
+
+} // namespace richlog
@@ -0,0 +1,189 @@
+#include "payload_reader.hpp"
+#include "scanner.hpp"
+#include <algorithm>
+#include <cctype>
+
+namespace richlog {
+
+bool PayloadReader::addLine(std::string_view logLine) {
+    RichLogLineView view;
+    if (!scanRichLogLine(logLine, view)) {
+        return false;
+    }
+    if (view.index == 0 && view.total == 0) {
+        if (view.hex.size() < 2) {
+            return false;
+        }
+        std::string target(view.hex.substr(0, view.hex.size() / 2 * 2));
+        std::transform(target.begin(), target.end(), target.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        references_.emplace(std::string(view.uuid), Reference{std::string(view.type), target});
+        return true;
+    }
+    if (view.total == 0 || view.index == 0 || view.index > view.total) {
+        return false;
+    }
+
+    auto it = payloads_.find(std::string(view.uuid));
+    if (it == payloads_.end()) {
+        Payload payload;
+        payload.type = std::string(view.type);
+        payload.total = view.total;
+        it = payloads_.emplace(std::string(view.uuid), std::move(payload)).first;
+    }
+
+    Payload& payload = it->second;
+    if (payload.type != view.type || payload.total != view.total) {
+        return false;
+    }
+
+    // 重复分片先到先得
+    if (!payload.hexChunks.emplace(view.index, std::string(view.hex)).second) {
+        return true;
+    }
+
+    size_t chunkBytes = view.hex.size() / 2;
+    if (view.index < view.total) {
+        if (chunkBytes == 0 || (payload.uniformChunkSize != 0 && payload.uniformChunkSize != chunkBytes)) {
+            payload.uniform = false;
+        } else {
+            payload.uniformChunkSize = chunkBytes;
+        }
+    }
+
+    // 末尾分片比其他分片大时不能按统一大小换算
+    auto last = payload.hexChunks.find(payload.total);
+    if (payload.total > 1 && payload.uniformChunkSize != 0 && last != payload.hexChunks.end() &&
+        last->second.size() / 2 > payload.uniformChunkSize) {
+        payload.uniform = false;
+    }
+    return true;
+}
+
+const PayloadReader::Payload* PayloadReader::findPayload(const std::string& uuid) const {
+    auto it = payloads_.find(uuid);
+    if (it != payloads_.end()) {
+        return &it->second;
+    }
+    auto reference = references_.find(uuid);
+    if (reference != references_.end()) {
+        it = payloads_.find(reference->second.target);
+        if (it != payloads_.end()) {
+            return &it->second;
+        }
+    }
+    return nullptr;
+}
+
+bool PayloadReader::chunkStart(const Payload& payload, uint32_t index, uint64_t& start) const {
+    if (index == 1) {
+        start = 0;
+        return true;
+    }
+    if (payload.uniform && payload.uniformChunkSize != 0) {
+        start = static_cast<uint64_t>(index - 1) * payload.uniformChunkSize;
+        return true;
+    }
+
+    // 分片大小不一致：累加前面各分片的长度
+    start = 0;
+    for (uint32_t i = 1; i < index; ++i) {
+        auto it = payload.hexChunks.find(i);
+        if (it == payload.hexChunks.end()) {
+            return false;
+        }
+        start += it->second.size() / 2;
+    }
+    return true;
+}
+
+std::vector<uint8_t> PayloadReader::read(const std::string& uuid, uint64_t offset, size_t length) const {
+    const Payload* found = findPayload(uuid);
+    if (!found || length == 0) {
+        return {};
+    }
+    const Payload& payload = *found;
+
+    // 定位 offset 所在的分片
+    uint32_t index = 1;
+    uint64_t inner = offset;
+    if (payload.uniform && payload.uniformChunkSize != 0) {
+        uint64_t chunkOffset = offset / payload.uniformChunkSize;
+        if (chunkOffset >= payload.total) {
+            return {};
+        }
+        index = static_cast<uint32_t>(chunkOffset + 1);
+        inner = offset - chunkOffset * payload.uniformChunkSize;
+    } else if (payload.total > 1 && payload.uniform) {
+        // 尚未收到任何非末尾分片，无法确定分片大小
+        return {};
+    }
+
+    // length 可以取很大的值（如 SIZE_MAX）表示读到末尾，只按载荷剩余字节数预留；
+    // 大小未知时不预留，由 resize 逐步扩容
+    std::vector<uint8_t> result;
+    uint64_t size = 0;
+    if (payloadSize(uuid, size) && offset < size) {
+        result.reserve(static_cast<size_t>(std::min<uint64_t>(length, size - offset)));
+    }
+    while (result.size() < length && index <= payload.total) {
+        auto chunkIt = payload.hexChunks.find(index);
+        if (chunkIt == payload.hexChunks.end()) {
+            break;
+        }
+
+        const std::string& hex = chunkIt->second;
+        size_t chunkBytes = hex.size() / 2;
+        if (inner >= chunkBytes) {
+            inner -= chunkBytes;
+            ++index;
+            continue;
+        }
+
+        size_t count = std::min<uint64_t>(length - result.size(), chunkBytes - inner);
+        size_t pos = result.size();
+        result.resize(pos + count);
+        decodeHex(std::string_view(hex).substr(static_cast<size_t>(inner) * 2, count * 2), result.data() + pos);
+        inner = 0;
+        ++index;
+    }
+    return result;
+}
+
+bool PayloadReader::payloadSize(const std::string& uuid, uint64_t& size) const {
+    const Payload* found = findPayload(uuid);
+    if (!found) {
+        return false;
+    }
+    const Payload& payload = *found;
+
+    auto last = payload.hexChunks.find(payload.total);
+    if (last == payload.hexChunks.end()) {
+        return false;
+    }
+    uint64_t start = 0;
+    if (payload.total > 1 && payload.uniform && payload.uniformChunkSize == 0) {
+        return false;
+    }
+    if (!chunkStart(payload, payload.total, start)) {
+        return false;
+    }
+    size = start + last->second.size() / 2;
+    return true;
+}
+
+bool PayloadReader::isComplete(const std::string& uuid) const {
+    const Payload* payload = findPayload(uuid);
+    return payload && payload->hexChunks.size() == payload->total;
+}
+
+std::string PayloadReader::typeOf(const std::string& uuid) const {
+    auto reference = references_.find(uuid);
+    if (reference != references_.end()) {
+        return reference->second.type;
+    }
+    auto it = payloads_.find(uuid);
+    return it != payloads_.end() ? it->second.type : std::string();
+}
+
+} // namespace richlog
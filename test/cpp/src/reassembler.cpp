@@ -0,0 +1,529 @@
+#include "reassembler.hpp"
+#include "scanner.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <functional>
+
+namespace richlog {
+
+namespace {
+
+// FNV-1a，用于比较重复分片的内容
+uint64_t chunkChecksum(const std::vector<uint8_t>& data) {
+    uint64_t hash = 1469598103934665603ull;
+    for (uint8_t byte : data) {
+        hash = (hash ^ byte) * 1099511628211ull;
+    }
+    return hash;
+}
+
+} // namespace
+
+// 分片数据来源：已解码的数据块，或尚未解码的十六进制
+struct ShardedReassembler::ChunkSource {
+    std::vector<uint8_t>* bytes = nullptr;
+    std::string_view hex;
+
+    void moveInto(std::vector<uint8_t>& out) {
+        if (bytes) {
+            out = std::move(*bytes);
+        } else {
+            out.clear();
+            decodeHex(hex, out);
+        }
+    }
+};
+
+ShardedReassembler::ShardedReassembler(const ReassemblerOptions& options)
+    : deterministicOrder_(options.deterministicOrder),
+      duplicatePolicy_(options.duplicatePolicy),
+      referenceCacheSize_(options.referenceCacheSize) {
+    size_t count = std::max<size_t>(1, options.shardCount);
+    finishedPerShard_ = (options.finishedCacheSize + count - 1) / count;
+    shards_.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+}
+
+size_t ShardedReassembler::shardOf(std::string_view uuid) const {
+    return std::hash<std::string_view>()(uuid) % shards_.size();
+}
+
+bool ShardedReassembler::add(RichLogBlock block, uint64_t sequence) {
+    if (isReferenceBlock(block)) {
+        return addReference(block, sequence);
+    }
+
+    Shard& shard = *shards_[shardOf(block.uuid)];
+    ChunkSource source;
+    source.bytes = &block.data;
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return addLocked(shard, block.type, block.uuid, block.index, block.total, source, sequence);
+}
+
+bool ShardedReassembler::add(const RichLogLineView& view, uint64_t sequence) {
+    if (view.index == 0 && view.total == 0) {
+        RichLogBlock block(std::string(view.type), std::string(view.uuid), 0, 0);
+        decodeHex(view.hex, block.data);
+        return isReferenceBlock(block) && addReference(block, sequence);
+    }
+
+    Shard& shard = *shards_[shardOf(view.uuid)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return addViewLocked(shard, view, sequence);
+}
+
+bool ShardedReassembler::addViewLocked(Shard& shard, const RichLogLineView& view, uint64_t sequence) {
+    ChunkSource source;
+    source.hex = view.hex;
+    return addLocked(shard, view.type, std::string(view.uuid), view.index, view.total, source, sequence);
+}
+
+void ShardedReassembler::addBatch(std::vector<std::pair<RichLogBlock, uint64_t>> blocks) {
+    // 先按分片分组，再逐个分片加锁写入
+    std::vector<std::vector<size_t>> byShard(shards_.size());
+    std::vector<size_t> references;
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        if (isReferenceBlock(blocks[i].first)) {
+            references.push_back(i);
+        } else {
+            byShard[shardOf(blocks[i].first.uuid)].push_back(i);
+        }
+    }
+
+    for (size_t s = 0; s < byShard.size(); ++s) {
+        if (byShard[s].empty()) {
+            continue;
+        }
+        Shard& shard = *shards_[s];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (size_t i : byShard[s]) {
+            RichLogBlock& block = blocks[i].first;
+            ChunkSource source;
+            source.bytes = &block.data;
+            addLocked(shard, block.type, block.uuid, block.index, block.total, source, blocks[i].second);
+        }
+    }
+
+    // 引用放在最后处理，同一批次内的被引用载荷此时已经完成
+    for (size_t i : references) {
+        addReference(blocks[i].first, blocks[i].second);
+    }
+}
+
+bool ShardedReassembler::addReference(const RichLogBlock& block, uint64_t sequence) {
+    std::string target = referencedUuid(block);
+    {
+        // 引用行同样可能被重复投递，引用 uuid 与普通载荷一样登记在所属分片中，只解析一次
+        Shard& shard = *shards_[shardOf(block.uuid)];
+        std::lock_guard<std::mutex> shardLock(shard.mutex);
+        if (touchFinished(shard, block.uuid)) {
+            duplicateChunks_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        rememberFinished(shard, block.uuid);
+    }
+
+    std::unique_lock<std::mutex> lock(referenceMutex_);
+    auto it = recentIndex_.find(target);
+    if (it != recentIndex_.end()) {
+        // 与写入端的 LRU 保持一致：被引用的载荷移到最近使用位置
+        recentPayloads_.splice(recentPayloads_.begin(), recentPayloads_, it->second);
+        const RecentPayload& recent = *it->second;
+
+        ReassembledPayload resolved;
+        resolved.type = block.type;
+        resolved.uuid = block.uuid;
+        resolved.data = *recent.data;
+        resolved.sequence = std::max(sequence, recent.sequence);
+        resolvedReferences_.push_back(std::move(resolved));
+        return true;
+    }
+    waitingReferences_[target].push_back(WaitingReference{block.type, block.uuid, sequence});
+    waitingCount_.fetch_add(1, std::memory_order_relaxed);
+    lock.unlock();
+
+    // 先登记等待、再查被引用载荷是否已结束：载荷在登记之后完成时，rememberCompleted
+    // 一定能看到这条等待；在登记之前完成时，这里一定能看到它的 uuid
+    if (!isFinished(target)) {
+        return true;
+    }
+    if (!cancelWaiting(target, block.uuid)) {
+        return true;    // 已被 rememberCompleted 解析
+    }
+    unresolvedReferences_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+bool ShardedReassembler::isFinished(const std::string& uuid) {
+    Shard& shard = *shards_[shardOf(uuid)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return touchFinished(shard, uuid);
+}
+
+bool ShardedReassembler::cancelWaiting(const std::string& target, const std::string& uuid) {
+    std::lock_guard<std::mutex> lock(referenceMutex_);
+    auto waiting = waitingReferences_.find(target);
+    if (waiting == waitingReferences_.end()) {
+        return false;
+    }
+    auto& references = waiting->second;
+    auto it = std::find_if(references.begin(), references.end(),
+                           [&](const WaitingReference& reference) { return reference.uuid == uuid; });
+    if (it == references.end()) {
+        return false;
+    }
+    references.erase(it);
+    if (references.empty()) {
+        waitingReferences_.erase(waiting);
+    }
+    waitingCount_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+void ShardedReassembler::abandonWaiting(const std::string& target) {
+    if (waitingCount_.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(referenceMutex_);
+    auto waiting = waitingReferences_.find(target);
+    if (waiting == waitingReferences_.end()) {
+        return;
+    }
+    for (const auto& reference : waiting->second) {
+        reportDropped(reference.uuid);
+    }
+    unresolvedReferences_.fetch_add(waiting->second.size(), std::memory_order_relaxed);
+    waitingCount_.fetch_sub(waiting->second.size(), std::memory_order_relaxed);
+    waitingReferences_.erase(waiting);
+}
+
+void ShardedReassembler::reportDropped(const std::string& uuid) {
+    std::lock_guard<std::mutex> lock(droppedMutex_);
+    dropped_.push_back(uuid);
+    droppedCount_.fetch_add(1, std::memory_order_release);
+}
+
+void ShardedReassembler::rememberCompleted(const ReassembledPayload& payload) {
+    // 调用方持有载荷所在分片的锁，与 addReference 中 isFinished 的加锁保证了
+    // waitingCount_ 的可见性；既不缓存也没有等待者时不拷贝数据、不取全局锁
+    bool cacheable = referenceCacheSize_ > 0 && payload.data.size() >= kMinDedupSize;
+    if (!cacheable && waitingCount_.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(referenceMutex_);
+    auto waiting = waitingReferences_.find(payload.uuid);
+    if (!cacheable && waiting == waitingReferences_.end()) {
+        return;
+    }
+
+    auto data = std::make_shared<const std::vector<uint8_t>>(payload.data);
+    if (waiting != waitingReferences_.end()) {
+        for (const auto& reference : waiting->second) {
+            ReassembledPayload resolved;
+            resolved.type = reference.type;
+            resolved.uuid = reference.uuid;
+            resolved.data = *data;
+            resolved.sequence = std::max(reference.sequence, payload.sequence);
+            resolvedReferences_.push_back(std::move(resolved));
+        }
+        waitingCount_.fetch_sub(waiting->second.size(), std::memory_order_relaxed);
+        waitingReferences_.erase(waiting);
+    }
+
+    if (!cacheable || recentIndex_.count(payload.uuid)) {
+        return;
+    }
+    recentPayloads_.push_front(RecentPayload{payload.uuid, data, payload.sequence});
+    recentIndex_[payload.uuid] = recentPayloads_.begin();
+    if (recentPayloads_.size() > referenceCacheSize_) {
+        recentIndex_.erase(recentPayloads_.back().uuid);
+        recentPayloads_.pop_back();
+    }
+}
+
+bool ShardedReassembler::touchFinished(Shard& shard, const std::string& uuid) {
+    auto it = shard.finishedIndex.find(uuid);
+    if (it == shard.finishedIndex.end()) {
+        return false;
+    }
+    shard.finished.splice(shard.finished.begin(), shard.finished, it->second);
+    return true;
+}
+
+void ShardedReassembler::rememberFinished(Shard& shard, const std::string& uuid) {
+    if (finishedPerShard_ == 0) {
+        return;
+    }
+    shard.finished.push_front(uuid);
+    shard.finishedIndex[uuid] = shard.finished.begin();
+    if (shard.finished.size() > finishedPerShard_) {
+        shard.finishedIndex.erase(shard.finished.back());
+        shard.finished.pop_back();
+    }
+}
+
+ShardedReassembler::Chunk* ShardedReassembler::findChunk(PendingPayload& payload, uint32_t index) {
+    if (index <= kDenseChunkLimit) {
+        size_t slot = index - 1;
+        bool present = slot / 64 < payload.present.size() && (payload.present[slot / 64] >> (slot % 64)) & 1;
+        return present ? &payload.dense[slot] : nullptr;
+    }
+    auto it = payload.sparse.find(index);
+    return it == payload.sparse.end() ? nullptr : &it->second;
+}
+
+ShardedReassembler::Chunk& ShardedReassembler::insertChunk(PendingPayload& payload, uint32_t index) {
+    if (index > kDenseChunkLimit) {
+        return payload.sparse[index];
+    }
+    size_t slot = index - 1;
+    if (payload.dense.size() <= slot) {
+        payload.dense.resize(slot + 1);
+        payload.present.resize(slot / 64 + 1, 0);
+    }
+    payload.present[slot / 64] |= uint64_t(1) << (slot % 64);
+    return payload.dense[slot];
+}
+
+bool ShardedReassembler::addLocked(Shard& shard, std::string_view type, const std::string& uuid,
+                                   uint32_t index, uint32_t total, ChunkSource& source, uint64_t sequence) {
+    if (total == 0 || index == 0 || index > total) {
+        return false;
+    }
+
+    auto it = shard.pending.find(uuid);
+    if (it == shard.pending.end()) {
+        // 载荷已经完成或丢弃：at-least-once 投递的迟到副本，不再开启新的载荷
+        if (touchFinished(shard, uuid)) {
+            duplicateChunks_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        PendingPayload payload;
+        payload.type = std::string(type);
+        payload.total = total;
+        it = shard.pending.emplace(uuid, std::move(payload)).first;
+    }
+
+    PendingPayload& payload = it->second;
+    if (payload.type != type || payload.total != total) {
+        return false;
+    }
+
+    if (Chunk* existing = findChunk(payload, index)) {
+        duplicateChunks_.fetch_add(1, std::memory_order_relaxed);
+        if (duplicatePolicy_ == DuplicatePolicy::Reject) {
+            return false;
+        }
+        // 默认先到先得，不解码；确定性模式下保留序号最小的一份
+        bool replace = deterministicOrder_ && sequence < existing->sequence;
+        bool verify = duplicatePolicy_ == DuplicatePolicy::VerifyChecksum;
+        if (replace || verify) {
+            std::vector<uint8_t> data;
+            source.moveInto(data);
+            uint64_t checksum = verify ? chunkChecksum(data) : 0;
+            if (verify && checksum != existing->checksum) {
+                conflictingChunks_.fetch_add(1, std::memory_order_relaxed);
+                payload.conflicted = true;
+            }
+            if (replace) {
+                existing->data = std::move(data);
+                existing->sequence = sequence;
+                existing->checksum = checksum;
+            }
+        }
+        return true;
+    }
+
+    Chunk& chunk = insertChunk(payload, index);
+    source.moveInto(chunk.data);
+    chunk.sequence = sequence;
+    if (duplicatePolicy_ == DuplicatePolicy::VerifyChecksum) {
+        chunk.checksum = chunkChecksum(chunk.data);
+    }
+    if (++payload.received != payload.total) {
+        return true;
+    }
+
+    if (payload.conflicted) {
+        // 无法判断哪一份是正确的，整个载荷作废
+        droppedPayloads_.fetch_add(1, std::memory_order_relaxed);
+        shard.pending.erase(it);
+        rememberFinished(shard, uuid);
+        reportDropped(uuid);
+        abandonWaiting(uuid);
+        return true;
+    }
+
+    // 所有分片到齐：索引互不相同且都在 [1, total] 内，按索引顺序拼接
+    ReassembledPayload completed;
+    completed.type = std::move(payload.type);
+    completed.uuid = uuid;
+    size_t totalSize = 0;
+    auto measure = [&](const Chunk& part) {
+        totalSize += part.data.size();
+        completed.sequence = std::max(completed.sequence, part.sequence);
+    };
+    for (const auto& part : payload.dense) {
+        measure(part);
+    }
+    for (const auto& entry : payload.sparse) {
+        measure(entry.second);
+    }
+    completed.data.reserve(totalSize);
+    for (const auto& part : payload.dense) {
+        completed.data.insert(completed.data.end(), part.data.begin(), part.data.end());
+    }
+    for (const auto& entry : payload.sparse) {
+        completed.data.insert(completed.data.end(), entry.second.data.begin(), entry.second.data.end());
+    }
+
+    shard.pending.erase(it);
+    rememberFinished(shard, uuid);
+    rememberCompleted(completed);
+    shard.completed.push_back(std::move(completed));
+    return true;
+}
+
+void ShardedReassembler::addLines(ThreadPool& pool, const std::vector<std::string>& lines,
+                                  uint64_t firstSequence) {
+    pool.parallelFor(0, lines.size(), 0, [&](size_t begin, size_t end) {
+        // 只扫描头部并按分片分组，十六进制在确认需要时才解码
+        std::vector<std::vector<std::pair<RichLogLineView, uint64_t>>> byShard(shards_.size());
+        std::vector<std::pair<RichLogLineView, uint64_t>> references;
+        for (size_t i = begin; i < end; ++i) {
+            RichLogLineView view;
+            if (!scanRichLogLine(lines[i], view)) {
+                continue;
+            }
+            if (view.index == 0 && view.total == 0) {
+                references.emplace_back(view, firstSequence + i);
+            } else {
+                byShard[shardOf(view.uuid)].emplace_back(view, firstSequence + i);
+            }
+        }
+
+        for (size_t s = 0; s < byShard.size(); ++s) {
+            if (byShard[s].empty()) {
+                continue;
+            }
+            Shard& shard = *shards_[s];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (const auto& entry : byShard[s]) {
+                addViewLocked(shard, entry.first, entry.second);
+            }
+        }
+
+        // 引用放在最后处理，同一批次内的被引用载荷此时已经完成
+        for (const auto& entry : references) {
+            add(entry.first, entry.second);
+        }
+    });
+}
+
+std::vector<ReassembledPayload> ShardedReassembler::takeCompleted() {
+    std::vector<ReassembledPayload> result;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for (auto& payload : shard->completed) {
+            result.push_back(std::move(payload));
+        }
+        shard->completed.clear();
+    }
+    {
+        std::lock_guard<std::mutex> lock(referenceMutex_);
+        for (auto& payload : resolvedReferences_) {
+            result.push_back(std::move(payload));
+        }
+        resolvedReferences_.clear();
+    }
+
+    if (deterministicOrder_) {
+        std::sort(result.begin(), result.end(),
+                  [](const ReassembledPayload& a, const ReassembledPayload& b) {
+                      if (a.sequence != b.sequence) {
+                          return a.sequence < b.sequence;
+                      }
+                      return a.uuid < b.uuid;
+                  });
+    }
+    return result;
+}
+
+std::vector<std::string> ShardedReassembler::takeDropped() {
+    // 绝大多数调用没有作废的 uuid，不取锁
+    if (droppedCount_.load(std::memory_order_acquire) == 0) {
+        return {};
+    }
+    std::vector<std::string> result;
+    std::lock_guard<std::mutex> lock(droppedMutex_);
+    result.swap(dropped_);
+    droppedCount_.store(0, std::memory_order_relaxed);
+    return result;
+}
+
+bool ShardedReassembler::abandon(const std::string& uuid, const std::string& target) {
+    if (!target.empty()) {
+        if (!cancelWaiting(target, uuid)) {
+            return false;
+        }
+        abandonedPayloads_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    Shard& shard = *shards_[shardOf(uuid)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.pending.find(uuid);
+    if (it == shard.pending.end()) {
+        return false;
+    }
+    shard.pending.erase(it);
+    rememberFinished(shard, uuid);
+    abandonWaiting(uuid);
+    abandonedPayloads_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+std::vector<std::string> ShardedReassembler::finishedUuids() const {
+    std::vector<std::string> result;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        result.insert(result.end(), shard->finished.begin(), shard->finished.end());
+    }
+    return result;
+}
+
+void ShardedReassembler::markFinished(const std::string& uuid) {
+    Shard& shard = *shards_[shardOf(uuid)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (!touchFinished(shard, uuid)) {
+        rememberFinished(shard, uuid);
+    }
+}
+
+ReassemblerStats ShardedReassembler::stats() const {
+    ReassemblerStats stats;
+    stats.duplicateChunks = duplicateChunks_.load(std::memory_order_relaxed);
+    stats.conflictingChunks = conflictingChunks_.load(std::memory_order_relaxed);
+    stats.droppedPayloads = droppedPayloads_.load(std::memory_order_relaxed);
+    stats.unresolvedReferences = unresolvedReferences_.load(std::memory_order_relaxed);
+    stats.abandonedPayloads = abandonedPayloads_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+size_t ShardedReassembler::pendingCount() const {
+    size_t count = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        count += shard->pending.size();
+    }
+    std::lock_guard<std::mutex> lock(referenceMutex_);
+    for (const auto& entry : waitingReferences_) {
+        count += entry.second.size();
+    }
+    return count;
+}
+
+} // namespace richlog
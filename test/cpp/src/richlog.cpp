@@ -1,12 +1,51 @@
 #include "richlog.hpp"
+#include "scanner.hpp"
 #include <regex>
 #include <sstream>
 #include <iomanip>
 #include <random>
 #include <algorithm>
+#include <stdexcept>
 
 namespace richlog {
 
+namespace {
+
+// FNV-1a 64 位哈希
+uint64_t hashPayload(const std::vector<uint8_t>& data) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (uint8_t byte : data) {
+        hash ^= byte;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// 解析十进制数字串，超出 uint32 范围时返回 false
+bool parseUint32(const std::string& digits, uint32_t& value) {
+    uint64_t result = 0;
+    for (char c : digits) {
+        result = result * 10 + static_cast<uint64_t>(c - '0');
+        if (result > UINT32_MAX) {
+            return false;
+        }
+    }
+    value = static_cast<uint32_t>(result);
+    return true;
+}
+
+} // namespace
+
+bool isReferenceBlock(const RichLogBlock& block) {
+    return block.index == 0 && block.total == 0 && !block.data.empty();
+}
+
+std::string referencedUuid(const RichLogBlock& block) {
+    std::string uuid;
+    appendHex(uuid, block.data.data(), block.data.size());
+    return uuid;
+}
+
 // RichLogParser 实现
 std::unique_ptr<RichLogBlock> RichLogParser::parse(const std::string& logLine) {
     if (!isRichLogFormat(logLine)) {
@@ -16,13 +55,22 @@ std::unique_ptr<RichLogBlock> RichLogParser::parse(const std::string& logLine) {
     // 匹配 RICHLOG:type,uuid,index,total,hexdata 格式
     std::regex pattern(R"(RICHLOG:([^,]+),([^,]+),(\d+),(\d+),([0-9a-fA-F]+))");
     std::smatch matches;
+    auto start = logLine.cbegin();
     
-    if (std::regex_search(logLine, matches, pattern)) {
+    while (std::regex_search(start, logLine.cend(), matches, pattern)) {
+        // index 或 total 超出 uint32 范围时该位置不算匹配，从下一个字符继续查找
+        uint32_t index = 0;
+        uint32_t total = 0;
+        if (!parseUint32(matches[3].str(), index) || !parseUint32(matches[4].str(), total)) {
+            start = matches[0].first + 1;
+            continue;
+        }
+
         auto block = std::make_unique<RichLogBlock>();
         block->type = matches[1].str();
         block->uuid = matches[2].str();
-        block->index = std::stoul(matches[3].str());
-        block->total = std::stoul(matches[4].str());
+        block->index = index;
+        block->total = total;
         
         // 解析十六进制数据
         std::string hexData = matches[5].str();
@@ -52,6 +100,32 @@ std::vector<RichLogBlock> RichLogEncoder::encode(
     
     std::vector<RichLogBlock> blocks;
     std::string uuid = generateUUID();
+    maxChunkSize = chunkSizeFor(type, uuid.size(), data.size(), maxChunkSize);
+    
+    if (dedupCapacity_ > 0 && data.size() >= kMinDedupSize) {
+        uint64_t hash = hashPayload(data);
+        auto found = dedupIndex_.find(hash);
+        // 哈希只用于查找，逐字节比较后才输出引用，碰撞不会导致读取端替换成其他载荷
+        if (found != dedupIndex_.end() && found->second->data == data) {
+            // 命中：移到最近使用位置，只输出引用块
+            dedupEntries_.splice(dedupEntries_.begin(), dedupEntries_, found->second);
+            RichLogBlock reference(type, uuid, 0, 0);
+            decodeHex(found->second->uuid, reference.data);
+            blocks.push_back(reference);
+            return blocks;
+        }
+        
+        if (found != dedupIndex_.end()) {
+            dedupEntries_.erase(found->second);
+            dedupIndex_.erase(found);
+        }
+        dedupEntries_.push_front(DedupEntry{hash, data, uuid});
+        dedupIndex_[hash] = dedupEntries_.begin();
+        if (dedupEntries_.size() > dedupCapacity_) {
+            dedupIndex_.erase(dedupEntries_.back().hash);
+            dedupEntries_.pop_back();
+        }
+    }
     
     size_t totalChunks = (data.size() + maxChunkSize - 1) / maxChunkSize;
     
@@ -93,8 +167,61 @@ std::string RichLogEncoder::generateUUID() {
     return uuid;
 }
 
+void RichLogEncoder::setMaxLineLength(size_t maxLineLength, size_t prefixLength) {
+    maxLineLength_ = maxLineLength;
+    linePrefixLength_ = prefixLength;
+}
+
+size_t RichLogEncoder::chunkSizeFor(const std::string& type, size_t uuidLength, size_t dataSize,
+                                    size_t maxChunkSize) const {
+    if (maxLineLength_ == 0) {
+        if (maxChunkSize == 0) {
+            throw std::invalid_argument("maxChunkSize must be greater than zero");
+        }
+        return maxChunkSize;
+    }
+    size_t chunkSize = chunkSizeForLineLength(maxLineLength_, linePrefixLength_, type, uuidLength, dataSize);
+    if (chunkSize == 0) {
+        throw std::invalid_argument("line length limit too small for a single payload byte");
+    }
+    return chunkSize;
+}
+
+size_t RichLogEncoder::chunkSizeForLineLength(size_t maxLineLength, size_t prefixLength,
+                                              const std::string& type, size_t uuidLength, size_t dataSize) {
+    // "RICHLOG:" 加四个逗号
+    const size_t fixed = prefixLength + 8 + type.size() + uuidLength + 4;
+    size_t digits = 1;
+    while (true) {
+        // 索引位数不超过总数位数，按总数位数预留
+        size_t overhead = fixed + 2 * digits;
+        if (maxLineLength < overhead + 2) {
+            return 0;
+        }
+        size_t chunkSize = (maxLineLength - overhead) / 2;
+        size_t chunks = std::max<size_t>(1, (dataSize + chunkSize - 1) / chunkSize);
+        size_t needed = std::to_string(chunks).size();
+        // 位数只增不减，分片大小随之单调减小，必然收敛
+        if (needed <= digits) {
+            return chunkSize;
+        }
+        digits = needed;
+    }
+}
+
+void RichLogEncoder::setDeduplication(size_t cacheSize) {
+    dedupCapacity_ = cacheSize;
+    while (dedupEntries_.size() > dedupCapacity_) {
+        dedupIndex_.erase(dedupEntries_.back().hash);
+        dedupEntries_.pop_back();
+    }
+}
+
 // RichLogDecoder 实现
 std::vector<uint8_t> RichLogDecoder::decode(const std::vector<RichLogBlock>& blocks) {
+    if (duplicatePolicy_ != DuplicatePolicy::Reject) {
+        return decodeTolerant(blocks);
+    }
     if (!validateBlocks(blocks)) {
         return {};
     }
@@ -114,6 +241,54 @@ std::vector<uint8_t> RichLogDecoder::decode(const std::vector<RichLogBlock>& blo
     return result;
 }
 
+std::vector<uint8_t> RichLogDecoder::decode(const std::vector<RichLogBlock>& blocks,
+                                            const PayloadLookup& lookup) {
+    if (blocks.size() == 1 && isReferenceBlock(blocks[0])) {
+        const std::vector<uint8_t>* target = lookup ? lookup(referencedUuid(blocks[0])) : nullptr;
+        return target ? *target : std::vector<uint8_t>();
+    }
+    return decode(blocks);
+}
+
+std::vector<uint8_t> RichLogDecoder::decodeTolerant(const std::vector<RichLogBlock>& blocks) const {
+    // 分片数少于总数时不可能完整，也避免按异常的 total 分配内存
+    if (blocks.empty() || blocks[0].total == 0 || blocks[0].total > blocks.size()) {
+        return {};
+    }
+
+    // 按索引直接放入对应位置，第一份到达的分片生效
+    const auto& firstBlock = blocks[0];
+    std::vector<const RichLogBlock*> slots(firstBlock.total, nullptr);
+    size_t received = 0;
+    for (const auto& block : blocks) {
+        if (block.uuid != firstBlock.uuid || block.type != firstBlock.type ||
+            block.total != firstBlock.total || block.index == 0 || block.index > block.total) {
+            return {};
+        }
+        const RichLogBlock*& slot = slots[block.index - 1];
+        if (!slot) {
+            slot = &block;
+            ++received;
+        } else if (duplicatePolicy_ == DuplicatePolicy::VerifyChecksum && slot->data != block.data) {
+            return {};
+        }
+    }
+    if (received != slots.size()) {
+        return {};
+    }
+
+    size_t totalSize = 0;
+    for (const auto* block : slots) {
+        totalSize += block->data.size();
+    }
+    std::vector<uint8_t> result;
+    result.reserve(totalSize);
+    for (const auto* block : slots) {
+        result.insert(result.end(), block->data.begin(), block->data.end());
+    }
+    return result;
+}
+
 bool RichLogDecoder::validateBlocks(const std::vector<RichLogBlock>& blocks) {
     if (blocks.empty()) {
         return false;
@@ -0,0 +1,74 @@
+#include "richlog_wasm.h"
+#include "stream_parser.hpp"
+#include <vector>
+
+using richlog::ReassembledPayload;
+using richlog::ReassemblerOptions;
+using richlog::StreamParser;
+
+struct richlog_stream {
+    StreamParser parser;
+    std::vector<uint8_t> input;
+    std::vector<ReassembledPayload> output;
+
+    richlog_stream() : parser(options()) {}
+
+    static ReassemblerOptions options() {
+        // 浏览器中单线程逐块输入，一个分片即可，按完成顺序输出
+        ReassemblerOptions options;
+        options.shardCount = 1;
+        options.deterministicOrder = true;
+        return options;
+    }
+};
+
+richlog_stream* richlog_stream_create(void) {
+    return new richlog_stream();
+}
+
+void richlog_stream_destroy(richlog_stream* stream) {
+    delete stream;
+}
+
+uint8_t* richlog_stream_buffer(richlog_stream* stream, size_t size) {
+    if (stream->input.size() < size) {
+        stream->input.resize(size);
+    }
+    return stream->input.data();
+}
+
+void richlog_stream_feed(richlog_stream* stream, size_t size) {
+    if (size > stream->input.size()) {
+        size = stream->input.size();
+    }
+    stream->parser.feed(reinterpret_cast<const char*>(stream->input.data()), size);
+}
+
+void richlog_stream_finish(richlog_stream* stream) {
+    stream->parser.finish();
+}
+
+size_t richlog_stream_poll(richlog_stream* stream) {
+    stream->output = stream->parser.takeCompleted();
+    return stream->output.size();
+}
+
+const char* richlog_payload_type(richlog_stream* stream, size_t index) {
+    return index < stream->output.size() ? stream->output[index].type.c_str() : nullptr;
+}
+
+const char* richlog_payload_uuid(richlog_stream* stream, size_t index) {
+    return index < stream->output.size() ? stream->output[index].uuid.c_str() : nullptr;
+}
+
+const uint8_t* richlog_payload_data(richlog_stream* stream, size_t index) {
+    return index < stream->output.size() ? stream->output[index].data.data() : nullptr;
+}
+
+size_t richlog_payload_size(richlog_stream* stream, size_t index) {
+    return index < stream->output.size() ? stream->output[index].data.size() : 0;
+}
+
+double richlog_payload_line(richlog_stream* stream, size_t index) {
+    return index < stream->output.size() ? static_cast<double>(stream->output[index].sequence) : -1.0;
+}
@@ -0,0 +1,369 @@
+#include "scanner.hpp"
+#include <array>
+#include <cstring>
+
+// 128 位向量实现：WebAssembly SIMD（emcc -msimd128）或 x86 SSE2，两者都没有时只用标量实现
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#define RICHLOG_SCANNER_SIMD 1
+#elif defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+#include <emmintrin.h>
+#define RICHLOG_SCANNER_SIMD 1
+#define RICHLOG_SCANNER_SSE2 1
+#else
+#define RICHLOG_SCANNER_SIMD 0
+#endif
+
+namespace richlog {
+
+namespace {
+
+constexpr std::string_view kMarker = "RICHLOG:";
+
+// 十六进制字符到数值的查找表，非法字符为 -1
+constexpr std::array<int8_t, 256> makeHexTable() {
+    std::array<int8_t, 256> table{};
+    for (auto& value : table) {
+        value = -1;
+    }
+    for (int c = '0'; c <= '9'; ++c) {
+        table[c] = static_cast<int8_t>(c - '0');
+    }
+    for (int c = 'a'; c <= 'f'; ++c) {
+        table[c] = static_cast<int8_t>(c - 'a' + 10);
+    }
+    for (int c = 'A'; c <= 'F'; ++c) {
+        table[c] = static_cast<int8_t>(c - 'A' + 10);
+    }
+    return table;
+}
+
+constexpr std::array<int8_t, 256> kHexTable = makeHexTable();
+
+inline bool isHexChar(char c) {
+    return kHexTable[static_cast<uint8_t>(c)] >= 0;
+}
+
+// 读取 [^,]+ 字段及其后的逗号
+bool scanField(std::string_view line, size_t& pos, std::string_view& field) {
+    size_t comma = line.find(',', pos);
+    if (comma == std::string_view::npos || comma == pos) {
+        return false;
+    }
+    field = line.substr(pos, comma - pos);
+    pos = comma + 1;
+    return true;
+}
+
+// 读取 \d+ 字段及其后的逗号
+bool scanNumber(std::string_view line, size_t& pos, uint32_t& value) {
+    uint64_t result = 0;
+    size_t start = pos;
+    while (pos < line.size() && line[pos] >= '0' && line[pos] <= '9') {
+        result = result * 10 + static_cast<uint64_t>(line[pos] - '0');
+        if (result > UINT32_MAX) {
+            return false;
+        }
+        ++pos;
+    }
+    if (pos == start || pos >= line.size() || line[pos] != ',') {
+        return false;
+    }
+    value = static_cast<uint32_t>(result);
+    ++pos;
+    return true;
+}
+
+size_t hexRunLength(const char* data, size_t size) {
+    size_t length = 0;
+    while (length < size && isHexChar(data[length])) {
+        ++length;
+    }
+    return length;
+}
+
+#if defined(RICHLOG_SCANNER_SSE2)
+// 每次检查 16 个位置的首字节 'R' 和末字节 ':'，两者都相同才比较整个标记
+size_t findMarkerSimd(std::string_view line, size_t from) {
+    const char* data = line.data();
+    const size_t size = line.size();
+    const size_t last = kMarker.size() - 1;
+    const __m128i first = _mm_set1_epi8(kMarker.front());
+    const __m128i colon = _mm_set1_epi8(kMarker.back());
+    size_t i = from;
+    for (; i + last + 16 <= size; i += 16) {
+        __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + last));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(first, blockFirst), _mm_cmpeq_epi8(colon, blockLast))));
+        while (mask != 0) {
+            size_t candidate = i + static_cast<size_t>(__builtin_ctz(mask));
+            if (std::memcmp(data + candidate + 1, kMarker.data() + 1, last - 1) == 0) {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return i >= size ? std::string_view::npos : line.find(kMarker, i);
+}
+
+// 十六进制字符的连续长度，一次分类 16 个字符
+size_t hexRunLengthSimd(const char* data, size_t size) {
+    const __m128i zeroBelow = _mm_set1_epi8('0' - 1);
+    const __m128i nineAbove = _mm_set1_epi8('9' + 1);
+    const __m128i aBelow = _mm_set1_epi8('a' - 1);
+    const __m128i fAbove = _mm_set1_epi8('f' + 1);
+    const __m128i lowerBit = _mm_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        // 有符号比较：0x80 以上的字节为负数，两个区间都不会命中
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(chunk, zeroBelow), _mm_cmplt_epi8(chunk, nineAbove));
+        __m128i lower = _mm_or_si128(chunk, lowerBit);
+        __m128i letter = _mm_and_si128(_mm_cmpgt_epi8(lower, aBelow), _mm_cmplt_epi8(lower, fAbove));
+        unsigned valid = static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(digit, letter)));
+        if (valid != 0xFFFF) {
+            return i + static_cast<size_t>(__builtin_ctz(~valid));
+        }
+    }
+    return i + hexRunLength(data + i, size - i);
+}
+
+// 解码已确认合法的十六进制：数字减 '0'，字母转小写后减 'a' - 10，再把相邻两个半字节合成一个字节
+void decodeHexSimd(std::string_view hex, uint8_t* out) {
+    const size_t count = hex.size() / 2;
+    const char* src = hex.data();
+    const __m128i nine = _mm_set1_epi8('9');
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i letterBase = _mm_set1_epi8('a' - 10);
+    const __m128i lowerBit = _mm_set1_epi8(0x20);
+    const __m128i lowByte = _mm_set1_epi16(0x00FF);
+    auto nibbles = [&](__m128i chars) {
+        __m128i isLetter = _mm_cmpgt_epi8(chars, nine);
+        __m128i digit = _mm_sub_epi8(chars, zero);
+        __m128i letter = _mm_sub_epi8(_mm_or_si128(chars, lowerBit), letterBase);
+        return _mm_or_si128(_mm_and_si128(isLetter, letter), _mm_andnot_si128(isLetter, digit));
+    };
+    auto combine = [&](__m128i values) {
+        // 每个 16 位通道低字节为高半字节，高字节为低半字节
+        return _mm_or_si128(_mm_slli_epi16(_mm_and_si128(values, lowByte), 4), _mm_srli_epi16(values, 8));
+    };
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i first = nibbles(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i)));
+        __m128i second = nibbles(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i + 16)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                         _mm_packus_epi16(combine(first), combine(second)));
+    }
+    decodeHex(hex.substr(2 * i, 2 * (count - i)), out + i);
+}
+#elif RICHLOG_SCANNER_SIMD
+// 以下为 WebAssembly SIMD 版本，逻辑与 SSE2 版本逐条对应
+size_t findMarkerSimd(std::string_view line, size_t from) {
+    const char* data = line.data();
+    const size_t size = line.size();
+    const size_t last = kMarker.size() - 1;
+    const v128_t first = wasm_i8x16_splat(kMarker.front());
+    const v128_t colon = wasm_i8x16_splat(kMarker.back());
+    size_t i = from;
+    for (; i + last + 16 <= size; i += 16) {
+        v128_t blockFirst = wasm_v128_load(data + i);
+        v128_t blockLast = wasm_v128_load(data + i + last);
+        unsigned mask = static_cast<unsigned>(wasm_i8x16_bitmask(
+            wasm_v128_and(wasm_i8x16_eq(first, blockFirst), wasm_i8x16_eq(colon, blockLast))));
+        while (mask != 0) {
+            size_t candidate = i + static_cast<size_t>(__builtin_ctz(mask));
+            if (std::memcmp(data + candidate + 1, kMarker.data() + 1, last - 1) == 0) {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return i >= size ? std::string_view::npos : line.find(kMarker, i);
+}
+
+size_t hexRunLengthSimd(const char* data, size_t size) {
+    const v128_t zeroBelow = wasm_i8x16_splat('0' - 1);
+    const v128_t nineAbove = wasm_i8x16_splat('9' + 1);
+    const v128_t aBelow = wasm_i8x16_splat('a' - 1);
+    const v128_t fAbove = wasm_i8x16_splat('f' + 1);
+    const v128_t lowerBit = wasm_i8x16_splat(0x20);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        v128_t chunk = wasm_v128_load(data + i);
+        // 有符号比较：0x80 以上的字节为负数，两个区间都不会命中
+        v128_t digit = wasm_v128_and(wasm_i8x16_gt(chunk, zeroBelow), wasm_i8x16_lt(chunk, nineAbove));
+        v128_t lower = wasm_v128_or(chunk, lowerBit);
+        v128_t letter = wasm_v128_and(wasm_i8x16_gt(lower, aBelow), wasm_i8x16_lt(lower, fAbove));
+        unsigned valid = static_cast<unsigned>(wasm_i8x16_bitmask(wasm_v128_or(digit, letter)));
+        if (valid != 0xFFFF) {
+            return i + static_cast<size_t>(__builtin_ctz(~valid));
+        }
+    }
+    return i + hexRunLength(data + i, size - i);
+}
+
+void decodeHexSimd(std::string_view hex, uint8_t* out) {
+    const size_t count = hex.size() / 2;
+    const char* src = hex.data();
+    const v128_t nine = wasm_i8x16_splat('9');
+    const v128_t zero = wasm_i8x16_splat('0');
+    const v128_t letterBase = wasm_i8x16_splat('a' - 10);
+    const v128_t lowerBit = wasm_i8x16_splat(0x20);
+    const v128_t lowByte = wasm_i16x8_splat(0x00FF);
+    auto nibbles = [&](v128_t chars) {
+        v128_t isLetter = wasm_i8x16_gt(chars, nine);
+        v128_t digit = wasm_i8x16_sub(chars, zero);
+        v128_t letter = wasm_i8x16_sub(wasm_v128_or(chars, lowerBit), letterBase);
+        return wasm_v128_bitselect(letter, digit, isLetter);
+    };
+    auto combine = [&](v128_t values) {
+        return wasm_v128_or(wasm_i16x8_shl(wasm_v128_and(values, lowByte), 4), wasm_u16x8_shr(values, 8));
+    };
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        v128_t first = nibbles(wasm_v128_load(src + 2 * i));
+        v128_t second = nibbles(wasm_v128_load(src + 2 * i + 16));
+        wasm_v128_store(out + i, wasm_u8x16_narrow_i16x8(combine(first), combine(second)));
+    }
+    decodeHex(hex.substr(2 * i, 2 * (count - i)), out + i);
+}
+#endif
+
+// 在 pos 处尝试匹配完整的 RICHLOG 行，Simd 为 true 时用向量指令查找十六进制的结尾
+template <bool Simd>
+bool matchAt(std::string_view line, size_t pos, RichLogLineView& view) {
+    pos += kMarker.size();
+    if (!scanField(line, pos, view.type) || !scanField(line, pos, view.uuid) ||
+        !scanNumber(line, pos, view.index) || !scanNumber(line, pos, view.total)) {
+        return false;
+    }
+
+#if RICHLOG_SCANNER_SIMD
+    size_t length = Simd ? hexRunLengthSimd(line.data() + pos, line.size() - pos)
+                         : hexRunLength(line.data() + pos, line.size() - pos);
+#else
+    size_t length = hexRunLength(line.data() + pos, line.size() - pos);
+#endif
+    if (length == 0) {
+        return false;
+    }
+    view.hex = line.substr(pos, length);
+    return true;
+}
+
+} // namespace
+
+size_t findRichLogMarker(std::string_view text, size_t from) {
+    if (from >= text.size()) {
+        return std::string_view::npos;
+    }
+#if RICHLOG_SCANNER_SIMD
+    return findMarkerSimd(text, from);
+#else
+    return text.find(kMarker, from);
+#endif
+}
+
+bool scanRichLogLine(std::string_view line, RichLogLineView& view) {
+    size_t pos = line.find(kMarker);
+    while (pos != std::string_view::npos) {
+        if (matchAt<false>(line, pos, view)) {
+            return true;
+        }
+        pos = line.find(kMarker, pos + 1);
+    }
+    return false;
+}
+
+bool scanRichLogLineSimd(std::string_view line, RichLogLineView& view) {
+#if RICHLOG_SCANNER_SIMD
+    size_t pos = findMarkerSimd(line, 0);
+    while (pos != std::string_view::npos) {
+        if (matchAt<true>(line, pos, view)) {
+            return true;
+        }
+        pos = findMarkerSimd(line, pos + 1);
+    }
+    return false;
+#else
+    return scanRichLogLine(line, view);
+#endif
+}
+
+bool decodeHex(std::string_view hex, uint8_t* out) {
+    const size_t count = hex.size() / 2;
+    const char* src = hex.data();
+    bool valid = true;
+    for (size_t i = 0; i < count; ++i) {
+        int8_t high = kHexTable[static_cast<uint8_t>(src[2 * i])];
+        int8_t low = kHexTable[static_cast<uint8_t>(src[2 * i + 1])];
+        valid &= (high | low) >= 0;
+        out[i] = static_cast<uint8_t>((high << 4) | (low & 0x0F));
+    }
+    return valid;
+}
+
+bool decodeHex(std::string_view hex, std::vector<uint8_t>& out) {
+    size_t offset = out.size();
+    out.resize(offset + hex.size() / 2);
+    return decodeHex(hex, out.data() + offset);
+}
+
+void appendHex(std::string& out, const uint8_t* data, size_t size) {
+    static const char* hexChars = "0123456789abcdef";
+    size_t offset = out.size();
+    out.resize(offset + size * 2);
+    char* dst = &out[offset];
+    for (size_t i = 0; i < size; ++i) {
+        dst[2 * i] = hexChars[data[i] >> 4];
+        dst[2 * i + 1] = hexChars[data[i] & 0x0F];
+    }
+}
+
+// FastRichLogParser 实现
+std::unique_ptr<RichLogBlock> FastRichLogParser::parse(const std::string& logLine) {
+    RichLogLineView view;
+    if (!scanRichLogLine(logLine, view)) {
+        return nullptr;
+    }
+
+    auto block = std::make_unique<RichLogBlock>(
+        std::string(view.type), std::string(view.uuid), view.index, view.total);
+    decodeHex(view.hex, block->data);
+    return block;
+}
+
+bool FastRichLogParser::isRichLogFormat(const std::string& logLine) {
+    return logLine.find(kMarker) != std::string::npos;
+}
+
+// SimdRichLogParser 实现
+std::unique_ptr<RichLogBlock> SimdRichLogParser::parse(const std::string& logLine) {
+    RichLogLineView view;
+    if (!scanRichLogLineSimd(logLine, view)) {
+        return nullptr;
+    }
+
+    auto block = std::make_unique<RichLogBlock>(
+        std::string(view.type), std::string(view.uuid), view.index, view.total);
+#if RICHLOG_SCANNER_SIMD
+    block->data.resize(view.hex.size() / 2);
+    decodeHexSimd(view.hex, block->data.data());
+#else
+    decodeHex(view.hex, block->data);
+#endif
+    return block;
+}
+
+bool SimdRichLogParser::isRichLogFormat(const std::string& logLine) {
+#if RICHLOG_SCANNER_SIMD
+    return findMarkerSimd(logLine, 0) != std::string_view::npos;
+#else
+    return logLine.find(kMarker) != std::string::npos;
+#endif
+}
+
+} // namespace richlog
@@ -0,0 +1,380 @@
+#include "stream_parser.hpp"
+#include "scanner.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <unordered_set>
+
+namespace richlog {
+
+namespace {
+
+constexpr const char* kCheckpointHeader = "richlog-checkpoint 1";
+
+bool parseNumber(std::string_view text, uint64_t& value) {
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size() && !text.empty();
+}
+
+// 读取下一个以空格结尾的字段
+bool nextToken(std::string_view& text, std::string_view& token) {
+    size_t space = text.find(' ');
+    if (space == std::string_view::npos || space == 0) {
+        return false;
+    }
+    token = text.substr(0, space);
+    text.remove_prefix(space + 1);
+    return true;
+}
+
+// 条目格式：<行数> <行号>:<偏移> ... <uuid>，uuid 放在最后以允许包含空格
+void writeEntry(std::ostringstream& out, const char* kind, const StreamCheckpoint::Entry& entry) {
+    out << kind << ' ' << entry.lines.size();
+    for (const auto& location : entry.lines) {
+        out << ' ' << location.line << ':' << location.offset;
+    }
+    out << ' ' << entry.uuid << '\n';
+}
+
+bool parseEntry(std::string_view text, StreamCheckpoint::Entry& entry) {
+    std::string_view token;
+    uint64_t count = 0;
+    if (!nextToken(text, token) || !parseNumber(token, count)) {
+        return false;
+    }
+    for (uint64_t i = 0; i < count; ++i) {
+        size_t colon;
+        LineLocation location;
+        if (!nextToken(text, token) || (colon = token.find(':')) == std::string_view::npos ||
+            !parseNumber(token.substr(0, colon), location.line) ||
+            !parseNumber(token.substr(colon + 1), location.offset)) {
+            return false;
+        }
+        entry.lines.push_back(location);
+    }
+    entry.uuid = std::string(text);
+    return !entry.uuid.empty();
+}
+
+} // namespace
+
+// StreamCheckpoint 实现
+std::string StreamCheckpoint::serialize() const {
+    std::ostringstream out;
+    out << kCheckpointHeader << '\n';
+    out << "position " << offset << ' ' << line << '\n';
+    for (const auto& entry : pending) {
+        writeEntry(out, "pending", entry);
+    }
+    for (const auto& entry : recent) {
+        writeEntry(out, "recent", entry);
+    }
+    for (const auto& uuid : finished) {
+        out << "finished " << uuid << '\n';
+    }
+    out << "end\n";
+    return out.str();
+}
+
+bool StreamCheckpoint::parse(const std::string& text, StreamCheckpoint& checkpoint) {
+    checkpoint = StreamCheckpoint();
+    std::istringstream in(text);
+    std::string row;
+    if (!std::getline(in, row) || row != kCheckpointHeader) {
+        return false;
+    }
+
+    bool hasPosition = false;
+    while (std::getline(in, row)) {
+        std::string_view rest(row);
+        std::string_view kind;
+        if (row == "end") {
+            return hasPosition;
+        }
+        if (!nextToken(rest, kind)) {
+            return false;
+        }
+        if (kind == "position") {
+            std::string_view offset;
+            hasPosition = nextToken(rest, offset) && parseNumber(offset, checkpoint.offset) &&
+                          parseNumber(rest, checkpoint.line);
+            if (!hasPosition) {
+                return false;
+            }
+        } else if (kind == "pending" || kind == "recent") {
+            Entry entry;
+            if (!parseEntry(rest, entry)) {
+                return false;
+            }
+            (kind == "pending" ? checkpoint.pending : checkpoint.recent).push_back(std::move(entry));
+        } else if (kind == "finished" && !rest.empty()) {
+            checkpoint.finished.emplace_back(rest);
+        } else {
+            return false;
+        }
+    }
+    return false;   // 缺少结束标记，文件不完整
+}
+
+bool StreamCheckpoint::save(const std::string& path) const {
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        std::string text = serialize();
+        file.write(text.data(), static_cast<std::streamsize>(text.size()));
+        if (!file.flush()) {
+            return false;
+        }
+    }
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+bool StreamCheckpoint::load(const std::string& path, StreamCheckpoint& checkpoint) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return parse(text, checkpoint);
+}
+
+// StreamParser 实现
+StreamParser::StreamParser(const ReassemblerOptions& options, uint64_t maxPendingLines)
+    : reassembler_(options),
+      referenceCacheSize_(options.referenceCacheSize),
+      maxPendingLines_(maxPendingLines) {}
+
+void StreamParser::feed(const char* data, size_t size) {
+    const char* end = data + size;
+    const char* cursor = data;
+
+    while (cursor < end) {
+        const char* newline = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+        if (!newline) {
+            partial_.append(cursor, end - cursor);
+            return;
+        }
+
+        if (partial_.empty()) {
+            processLine(std::string_view(cursor, newline - cursor), consumed_);
+            consumed_ += (newline - cursor) + 1;
+        } else {
+            // 拼接上一块遗留的行首
+            partial_.append(cursor, newline - cursor);
+            processLine(partial_, consumed_);
+            consumed_ += partial_.size() + 1;
+            partial_.clear();
+        }
+        cursor = newline + 1;
+    }
+}
+
+void StreamParser::finish() {
+    if (!partial_.empty()) {
+        processLine(partial_, consumed_);
+        consumed_ += partial_.size();
+        partial_.clear();
+    }
+}
+
+std::vector<ReassembledPayload> StreamParser::takeCompleted() {
+    auto completed = reassembler_.takeCompleted();
+    if (!restored_.empty()) {
+        // 恢复时重放出的载荷早于之后输入的任何载荷
+        completed.insert(completed.begin(), std::make_move_iterator(restored_.begin()),
+                         std::make_move_iterator(restored_.end()));
+        restored_.clear();
+    }
+
+    // 取走的载荷不再需要重放，可被引用的普通载荷转入最近完成列表供引用解析，
+    // 与重组器的最近载荷缓存保持一致
+    for (const auto& payload : completed) {
+        auto it = inFlight_.find(payload.uuid);
+        if (it == inFlight_.end()) {
+            continue;
+        }
+        if (it->second.target.empty()) {
+            if (payload.data.size() >= kMinDedupSize) {
+                rememberRecent(payload.uuid, std::move(it->second.lines));
+            }
+        } else {
+            touchRecent(it->second.target);
+        }
+        inFlight_.erase(it);
+    }
+    return completed;
+}
+
+StreamCheckpoint StreamParser::checkpoint() const {
+    StreamCheckpoint checkpoint;
+    checkpoint.offset = consumed_;
+    checkpoint.line = lineNumber_;
+    for (const auto& entry : inFlight_) {
+        checkpoint.pending.push_back(StreamCheckpoint::Entry{entry.first, entry.second.lines});
+    }
+    std::sort(checkpoint.pending.begin(), checkpoint.pending.end(),
+              [](const StreamCheckpoint::Entry& a, const StreamCheckpoint::Entry& b) {
+                  return a.lines.front().line < b.lines.front().line;
+              });
+    for (const auto& recent : recent_) {
+        checkpoint.recent.push_back(StreamCheckpoint::Entry{recent.uuid, recent.lines});
+    }
+    checkpoint.finished = reassembler_.finishedUuids();
+    return checkpoint;
+}
+
+bool StreamParser::restore(const StreamCheckpoint& checkpoint, std::istream& input) {
+    input.clear();
+    input.seekg(0, std::ios::end);
+    std::streamoff size = input.tellg();
+    if (size < 0 || static_cast<uint64_t>(size) < checkpoint.offset) {
+        return false;
+    }
+
+    std::string text;
+    auto replay = [&](const LineLocation& location) {
+        if (location.offset >= checkpoint.offset || location.line >= checkpoint.line) {
+            return false;
+        }
+        input.clear();
+        input.seekg(static_cast<std::streamoff>(location.offset));
+        if (!std::getline(input, text)) {
+            return false;
+        }
+        processLine(text, location.offset, location.line);
+        return true;
+    };
+
+    // 先按从旧到新的顺序重放最近完成的载荷，重组器的引用缓存顺序与保存时一致
+    std::unordered_set<std::string> seeds;
+    for (auto it = checkpoint.recent.rbegin(); it != checkpoint.recent.rend(); ++it) {
+        seeds.insert(it->uuid);
+        for (const auto& location : it->lines) {
+            if (!replay(location)) {
+                return false;
+            }
+        }
+    }
+
+    // 再按行号顺序重放未取走的载荷，重复分片的取舍与首次处理相同
+    std::vector<LineLocation> pending;
+    for (const auto& entry : checkpoint.pending) {
+        pending.insert(pending.end(), entry.lines.begin(), entry.lines.end());
+    }
+    std::sort(pending.begin(), pending.end(),
+              [](const LineLocation& a, const LineLocation& b) { return a.line < b.line; });
+    for (const auto& location : pending) {
+        if (!replay(location)) {
+            return false;
+        }
+    }
+
+    // 最近完成的载荷已经交给过调用方，不再输出
+    for (auto& payload : reassembler_.takeCompleted()) {
+        auto it = inFlight_.find(payload.uuid);
+        if (seeds.count(payload.uuid) && it != inFlight_.end() && it->second.target.empty()) {
+            inFlight_.erase(it);
+        } else {
+            restored_.push_back(std::move(payload));
+        }
+    }
+    for (auto it = checkpoint.recent.rbegin(); it != checkpoint.recent.rend(); ++it) {
+        rememberRecent(it->uuid, it->lines);
+    }
+    // 重放之后再登记已结束的 uuid，避免拒绝重放的行；按从旧到新的顺序恢复淘汰顺序
+    for (auto it = checkpoint.finished.rbegin(); it != checkpoint.finished.rend(); ++it) {
+        reassembler_.markFinished(*it);
+    }
+
+    consumed_ = checkpoint.offset;
+    lineNumber_ = checkpoint.line;
+    partial_.clear();
+    return true;
+}
+
+void StreamParser::processLine(std::string_view line, uint64_t offset) {
+    processLine(line, offset, lineNumber_++);
+    expireStale();
+}
+
+void StreamParser::processLine(std::string_view line, uint64_t offset, uint64_t lineNumber) {
+    RichLogLineView view;
+    if (!scanRichLogLine(line, view)) {
+        return;
+    }
+
+    std::string target;
+    if (view.index == 0 && view.total == 0) {
+        RichLogBlock reference(std::string(view.type), std::string(view.uuid), 0, 0);
+        decodeHex(view.hex, reference.data);
+        target = referencedUuid(reference);
+    }
+    // 交给重组器的是未解码的行视图，重复分片不会被解码
+    if (!reassembler_.add(view, lineNumber)) {
+        return;
+    }
+
+    InFlight& entry = inFlight_[std::string(view.uuid)];
+    if (entry.lines.empty()) {
+        firstLines_.emplace_back(lineNumber, std::string(view.uuid));
+    }
+    entry.lines.push_back(LineLocation{lineNumber, offset});
+    entry.target = std::move(target);
+    forgetDropped();
+}
+
+void StreamParser::forgetDropped() {
+    // 作废的载荷和随之放弃的引用不会再完成，不必写进检查点重放
+    for (const auto& uuid : reassembler_.takeDropped()) {
+        inFlight_.erase(uuid);
+    }
+}
+
+void StreamParser::expireStale() {
+    if (maxPendingLines_ == 0) {
+        return;
+    }
+    // 距刚处理的一行超过 maxPendingLines 的载荷到期；firstLines_ 中已完成的 uuid 不立即删除，到期时跳过
+    uint64_t current = lineNumber_ - 1;
+    while (!firstLines_.empty() && firstLines_.front().first + maxPendingLines_ < current) {
+        auto it = inFlight_.find(firstLines_.front().second);
+        if (it != inFlight_.end() && it->second.lines.front().line == firstLines_.front().first) {
+            reassembler_.abandon(it->first, it->second.target);
+            inFlight_.erase(it);
+            forgetDropped();
+        }
+        firstLines_.pop_front();
+    }
+}
+
+void StreamParser::touchRecent(const std::string& uuid) {
+    auto it = recentIndex_.find(uuid);
+    if (it != recentIndex_.end()) {
+        recent_.splice(recent_.begin(), recent_, it->second);
+    }
+}
+
+void StreamParser::rememberRecent(const std::string& uuid, std::vector<LineLocation> lines) {
+    if (referenceCacheSize_ == 0) {
+        return;
+    }
+    auto it = recentIndex_.find(uuid);
+    if (it != recentIndex_.end()) {
+        recent_.erase(it->second);
+    }
+    recent_.push_front(RecentPayload{uuid, std::move(lines)});
+    recentIndex_[uuid] = recent_.begin();
+    if (recent_.size() > referenceCacheSize_) {
+        recentIndex_.erase(recent_.back().uuid);
+        recent_.pop_back();
+    }
+}
+
+} // namespace richlog
@@ -0,0 +1,218 @@
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <exception>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace richlog {
+
+namespace {
+
+// 记录当前线程所属的线程池及其工作线程编号
+struct WorkerContext {
+    const ThreadPool* pool = nullptr;
+    size_t index = ThreadPool::npos;
+};
+
+thread_local WorkerContext currentWorker;
+
+void pinThread(std::thread& thread, int cpu) {
+#if defined(__linux__)
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        return;
+    }
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(cpu, &cpuSet);
+    // 绑定失败（例如 CPU 不在允许集合内）时保持默认调度
+    pthread_setaffinity_np(thread.native_handle(), sizeof(cpuSet), &cpuSet);
+#else
+    (void)thread;
+    (void)cpu;
+#endif
+}
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    ThreadPoolOptions options;
+    options.threadCount = threadCount;
+    start(options);
+}
+
+ThreadPool::ThreadPool(const ThreadPoolOptions& options) {
+    start(options);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_ = true;
+    }
+    wakeCondition_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void ThreadPool::start(const ThreadPoolOptions& options) {
+    size_t count = options.threadCount;
+    if (count == 0) {
+        count = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    queues_.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    threads_.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        threads_.emplace_back(&ThreadPool::workerLoop, this, i);
+        if (!options.cpuAffinity.empty()) {
+            pinThread(threads_.back(), options.cpuAffinity[i % options.cpuAffinity.size()]);
+        }
+    }
+}
+
+size_t ThreadPool::currentWorkerIndex() const {
+    return currentWorker.pool == this ? currentWorker.index : npos;
+}
+
+void ThreadPool::post(Task task) {
+    size_t target = currentWorkerIndex();
+    if (target == npos) {
+        target = nextQueue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+    }
+
+    pendingTasks_.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(queues_[target]->mutex);
+        queues_[target]->tasks.push_back(std::move(task));
+    }
+    {
+        // 在 sleepMutex_ 内递增，避免与工作线程的休眠判断产生丢失唤醒
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        queuedTasks_.fetch_add(1);
+    }
+    wakeCondition_.notify_one();
+}
+
+bool ThreadPool::popLocal(size_t index, Task& task) {
+    auto& queue = *queues_[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::steal(size_t thief, Task& task) {
+    const size_t count = queues_.size();
+    for (size_t offset = 1; offset < count; ++offset) {
+        auto& queue = *queues_[(thief + offset) % count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::finishTask() {
+    if (pendingTasks_.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        idleCondition_.notify_all();
+    }
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    currentWorker.pool = this;
+    currentWorker.index = index;
+
+    while (true) {
+        Task task;
+        if (popLocal(index, task) || steal(index, task)) {
+            queuedTasks_.fetch_sub(1);
+            task();
+            finishTask();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        wakeCondition_.wait(lock, [this]() { return stopping_ || queuedTasks_.load() > 0; });
+        if (stopping_ && queuedTasks_.load() == 0) {
+            return;
+        }
+    }
+}
+
+void ThreadPool::waitIdle() {
+    std::unique_lock<std::mutex> lock(sleepMutex_);
+    idleCondition_.wait(lock, [this]() { return pendingTasks_.load() == 0; });
+}
+
+void ThreadPool::parallelFor(size_t begin, size_t end, size_t grainSize,
+                             const std::function<void(size_t, size_t)>& body) {
+    if (begin >= end) {
+        return;
+    }
+
+    const size_t length = end - begin;
+    if (grainSize == 0) {
+        // 每个线程大约分到 4 个分片，便于窃取时均衡
+        grainSize = std::max<size_t>(1, length / (size() * 4));
+    }
+    const size_t chunkCount = (length + grainSize - 1) / grainSize;
+
+    struct State {
+        std::atomic<size_t> nextChunk{0};
+        std::atomic<size_t> doneChunks{0};
+        std::mutex mutex;
+        std::condition_variable done;
+        std::exception_ptr error;
+    };
+    auto state = std::make_shared<State>();
+
+    // 调用线程和辅助任务共同领取分片；辅助任务启动得晚时领取不到分片，直接退出
+    auto runChunks = [state, begin, end, grainSize, chunkCount, &body]() {
+        size_t chunk;
+        while ((chunk = state->nextChunk.fetch_add(1)) < chunkCount) {
+            size_t chunkBegin = begin + chunk * grainSize;
+            size_t chunkEnd = std::min(chunkBegin + grainSize, end);
+            try {
+                body(chunkBegin, chunkEnd);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (!state->error) {
+                    state->error = std::current_exception();
+                }
+            }
+            if (state->doneChunks.fetch_add(1) + 1 == chunkCount) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->done.notify_all();
+            }
+        }
+    };
+
+    const size_t helpers = std::min(size(), chunkCount - 1);
+    for (size_t i = 0; i < helpers; ++i) {
+        post(runChunks);
+    }
+    runChunks();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&]() { return state->doneChunks.load() == chunkCount; });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+} // namespace richlog
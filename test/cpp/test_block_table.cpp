@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include "block_table.hpp"
+#include "scanner.hpp"
+#include <string>
+#include <vector>
+
+using namespace richlog;
+
+class BlockTableTest : public ::testing::Test {
+protected:
+    // 构造若干交错的载荷，返回原始数据
+    std::vector<std::vector<uint8_t>> appendInterleaved(BlockTable& table, size_t count) {
+        std::vector<std::vector<uint8_t>> originals;
+        std::vector<std::vector<RichLogBlock>> payloads;
+        for (size_t p = 0; p < count; ++p) {
+            std::vector<uint8_t> data(30 + p * 11);
+            for (size_t i = 0; i < data.size(); ++i) {
+                data[i] = static_cast<uint8_t>(i * 5 + p);
+            }
+            originals.push_back(data);
+            payloads.push_back(encoder.encode(p % 2 ? "config" : "image", data, 8));
+        }
+        for (size_t round = 0; round < payloads.back().size(); ++round) {
+            for (const auto& blocks : payloads) {
+                if (round < blocks.size()) {
+                    table.append(blocks[round]);
+                }
+            }
+        }
+        return originals;
+    }
+
+    RichLogEncoder encoder;
+    RichLogDecoder decoder;
+};
+
+TEST_F(BlockTableTest, Append_Block_RoundTripsThroughRecord) {
+    BlockTable table;
+    RichLogBlock block("image", "5f35c0af", 2, 3);
+    block.data = {0x89, 0x50, 0x4e, 0x47};
+
+    EXPECT_EQ(table.append(RichLogBlock("image", "5f35c0af", 1, 3)), 0u);
+    EXPECT_EQ(table.append(block), 1u);
+
+    const BlockRecord& record = table.records()[1];
+    EXPECT_EQ(record.uuid, table.records()[0].uuid);
+    EXPECT_EQ(record.typeId, table.records()[0].typeId);
+    EXPECT_EQ(record.index, 2u);
+    EXPECT_EQ(record.length, 4u);
+    EXPECT_EQ(table.uuid(record.uuid), "5f35c0af");
+    EXPECT_EQ(table.type(record.typeId), "image");
+
+    RichLogBlock restored = table.toBlock(record);
+    EXPECT_EQ(restored.type, block.type);
+    EXPECT_EQ(restored.uuid, block.uuid);
+    EXPECT_EQ(restored.total, block.total);
+    EXPECT_EQ(restored.data, block.data);
+}
+
+TEST_F(BlockTableTest, Append_LineView_DecodesHexIntoTable) {
+    BlockTable table;
+    RichLogLineView view;
+    ASSERT_TRUE(scanRichLogLine("[2023-08-15 10:00:01.236] RICHLOG:config,8b31b4cf,1,1,7B0a7d", view));
+    ASSERT_TRUE(table.append(view));
+
+    ASSERT_EQ(table.size(), 1u);
+    EXPECT_EQ(table.toBlock(table.records()[0]).data, std::vector<uint8_t>({0x7b, 0x0a, 0x7d}));
+
+    view.hex = "zz";
+    EXPECT_FALSE(table.append(view));
+    EXPECT_EQ(table.size(), 1u);
+}
+
+TEST_F(BlockTableTest, GroupByUuid_InterleavedPayloads_DecodeToOriginals) {
+    BlockTable table;
+    auto originals = appendInterleaved(table, 9);
+
+    auto ranges = table.groupByUuid();
+    ASSERT_EQ(ranges.size(), originals.size());
+    for (size_t p = 0; p < ranges.size(); ++p) {
+        // 组按 uuid 首次出现的顺序排列，与载荷顺序一致
+        EXPECT_TRUE(decoder.validateBlocks(table, ranges[p]));
+        EXPECT_EQ(decoder.decode(table, ranges[p]), originals[p]);
+
+        // 与 RichLogBlock 版本的结果一致
+        std::vector<RichLogBlock> blocks;
+        for (size_t i = 0; i < ranges[p].count; ++i) {
+            blocks.push_back(table.toBlock(table.records()[ranges[p].begin + i]));
+        }
+        EXPECT_EQ(decoder.decode(blocks), originals[p]);
+    }
+}
+
+TEST_F(BlockTableTest, ValidateBlocks_InvalidRecords_MatchesBlockRules) {
+    auto check = [&](std::vector<RichLogBlock> blocks) {
+        BlockTable table;
+        for (const auto& block : blocks) {
+            table.append(block);
+        }
+        BlockRange range{0, 0, table.size()};
+        EXPECT_EQ(decoder.validateBlocks(table, range), decoder.validateBlocks(blocks));
+        return decoder.validateBlocks(table, range);
+    };
+
+    EXPECT_TRUE(check({RichLogBlock("test", "abc123", 2, 2), RichLogBlock("test", "abc123", 1, 2)}));
+    EXPECT_FALSE(check({RichLogBlock("test", "abc123", 1, 2), RichLogBlock("test", "def456", 2, 2)}));
+    EXPECT_FALSE(check({RichLogBlock("test", "abc123", 1, 2), RichLogBlock("image", "abc123", 2, 2)}));
+    EXPECT_FALSE(check({RichLogBlock("test", "abc123", 2, 2), RichLogBlock("test", "abc123", 2, 2)}));
+    EXPECT_FALSE(check({RichLogBlock("test", "abc123", 1, 3), RichLogBlock("test", "abc123", 2, 3)}));
+    EXPECT_FALSE(check({RichLogBlock("test", "abc123", 0, 1)}));
+
+    BlockTable empty;
+    EXPECT_FALSE(decoder.validateBlocks(empty, BlockRange{}));
+    EXPECT_TRUE(decoder.decode(empty, BlockRange{0, 0, 1}).empty());
+}
+
+TEST_F(BlockTableTest, Decode_DuplicateRecords_FollowsDuplicatePolicy) {
+    BlockTable table;
+    RichLogBlock first("test", "abc123", 1, 2);
+    first.data = {'A', 'B'};
+    RichLogBlock second("test", "abc123", 2, 2);
+    second.data = {'C', 'D'};
+    RichLogBlock duplicate = first;
+    duplicate.data = {'X', 'X'};
+    table.append(second);
+    table.append(first);
+    table.append(duplicate);
+    BlockRange range{0, 0, 3};
+
+    EXPECT_TRUE(decoder.decode(table, range).empty());
+
+    decoder.setDuplicatePolicy(DuplicatePolicy::FirstWins);
+    EXPECT_EQ(decoder.decode(table, range), std::vector<uint8_t>({'A', 'B', 'C', 'D'}));
+
+    decoder.setDuplicatePolicy(DuplicatePolicy::VerifyChecksum);
+    EXPECT_TRUE(decoder.decode(table, range).empty());
+    EXPECT_EQ(decoder.decode(table, BlockRange{0, 0, 2}), std::vector<uint8_t>({'A', 'B', 'C', 'D'}));
+}
@@ -166,3 +166,46 @@ TEST_F(DecoderTest, Decode_LargeData_HandlesCorrectly) {
     
     EXPECT_EQ(decoded, largeData);
 }
+
+TEST_F(DecoderTest, Decode_ReferenceBlock_ResolvesThroughLookup) {
+    std::vector<uint8_t> original = {'A', 'B', 'C'};
+    RichLogBlock reference("config", "1a2b3c4d", 0, 0);
+    reference.data = {0x5f, 0x35, 0xc0, 0xaf};
+
+    auto lookup = [&](const std::string& uuid) -> const std::vector<uint8_t>* {
+        return uuid == "5f35c0af" ? &original : nullptr;
+    };
+
+    EXPECT_EQ(decoder.decode({reference}, lookup), original);
+    EXPECT_TRUE(decoder.decode({reference}).empty());
+
+    reference.data = {0x00, 0x00, 0x00, 0x01};
+    EXPECT_TRUE(decoder.decode({reference}, lookup).empty());
+}
+
+TEST_F(DecoderTest, Decode_DuplicateBlocksWithTolerantPolicy_ReturnsData) {
+    std::vector<RichLogBlock> blocks = {
+        RichLogBlock("test", "abc123", 2, 2), RichLogBlock("test", "abc123", 1, 2),
+        RichLogBlock("test", "abc123", 2, 2)};
+    blocks[0].data = {'C', 'D'};
+    blocks[1].data = {'A', 'B'};
+    blocks[2].data = {'X', 'X'};
+
+    // 默认策略与 validateBlocks 一致，重复分片视为无效
+    EXPECT_FALSE(decoder.validateBlocks(blocks));
+    EXPECT_TRUE(decoder.decode(blocks).empty());
+
+    decoder.setDuplicatePolicy(DuplicatePolicy::FirstWins);
+    EXPECT_EQ(decoder.decode(blocks), std::vector<uint8_t>({'A', 'B', 'C', 'D'}));
+    EXPECT_FALSE(decoder.validateBlocks(blocks));
+
+    // 内容不同的重复分片无法确定哪一份正确
+    decoder.setDuplicatePolicy(DuplicatePolicy::VerifyChecksum);
+    EXPECT_TRUE(decoder.decode(blocks).empty());
+    blocks[2].data = {'C', 'D'};
+    EXPECT_EQ(decoder.decode(blocks), std::vector<uint8_t>({'A', 'B', 'C', 'D'}));
+
+    // 缺少分片仍然无效
+    blocks.erase(blocks.begin() + 1);
+    EXPECT_TRUE(decoder.decode(blocks).empty());
+}
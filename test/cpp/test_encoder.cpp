@@ -1,8 +1,11 @@
 #include <gtest/gtest.h>
 #include "richlog.hpp"
+#include "test_helpers.hpp"
 #include <string>
 #include <vector>
 #include <regex>
+#include <algorithm>
+#include <stdexcept>
 
 using namespace richlog;
 
@@ -112,3 +115,95 @@ TEST_F(EncoderTest, Encode_DataReconstruction_IsCorrect) {
     std::string reconstructedString(reconstructed.begin(), reconstructed.end());
     EXPECT_EQ(reconstructedString, originalData);
 }
+
+TEST_F(EncoderTest, Encode_Deduplication_RepeatedPayloadBecomesReference) {
+    std::string config = R"({"server": {"host": "localhost", "port": 8080}})";
+    std::vector<uint8_t> data(config.begin(), config.end());
+    encoder.setDeduplication(4);
+
+    auto first = encoder.encode("config", data, 16);
+    auto second = encoder.encode("config", data, 16);
+
+    ASSERT_EQ(second.size(), 1);
+    EXPECT_TRUE(isReferenceBlock(second[0]));
+    EXPECT_EQ(second[0].type, "config");
+    EXPECT_EQ(second[0].index, 0);
+    EXPECT_EQ(second[0].total, 0);
+    EXPECT_NE(second[0].uuid, first[0].uuid);
+    EXPECT_EQ(referencedUuid(second[0]), first[0].uuid);
+    EXPECT_FALSE(isReferenceBlock(first[0]));
+}
+
+TEST_F(EncoderTest, Encode_Deduplication_DisabledByDefaultAndBounded) {
+    std::vector<uint8_t> data(100, 0x42);
+
+    auto plain = encoder.encode("test", data);
+    EXPECT_FALSE(isReferenceBlock(encoder.encode("test", data)[0]));
+
+    encoder.setDeduplication(2);
+    auto original = encoder.encode("test", data);
+    std::vector<uint8_t> other1(100, 0x01);
+    std::vector<uint8_t> other2(100, 0x02);
+    encoder.encode("test", other1);
+    encoder.encode("test", other2);
+
+    // 缓存容量为 2，原始载荷已被淘汰
+    EXPECT_FALSE(isReferenceBlock(encoder.encode("test", data)[0]));
+
+    // 太小的载荷不去重
+    std::vector<uint8_t> tiny = {1, 2, 3};
+    encoder.encode("test", tiny);
+    EXPECT_FALSE(isReferenceBlock(encoder.encode("test", tiny)[0]));
+}
+
+TEST_F(EncoderTest, ChunkSizeForLineLength_AccountsForIndexDigits) {
+    // 固定开销: "RICHLOG:" + "t" + 8 位 uuid + 4 个逗号 = 21，索引和总数各 1 位时为 23
+    EXPECT_EQ(RichLogEncoder::chunkSizeForLineLength(35, 0, "t", 8, 54), 6u);
+    // 10 个分片需要两位数字，重新计算后为 12 个 5 字节分片
+    EXPECT_EQ(RichLogEncoder::chunkSizeForLineLength(35, 0, "t", 8, 60), 5u);
+    EXPECT_EQ(RichLogEncoder::chunkSizeForLineLength(35, 10, "t", 8, 0), 1u);
+    EXPECT_EQ(RichLogEncoder::chunkSizeForLineLength(24, 0, "t", 8, 10), 0u);
+}
+
+TEST_F(EncoderTest, Encode_MaxLineLength_LinesFitLimit) {
+    const size_t limit = 200;
+    std::vector<uint8_t> data(5000);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>(i * 31);
+    }
+    encoder.setMaxLineLength(limit, kTestLinePrefix.size());
+
+    auto blocks = encoder.encode("image", data, 16);
+    ASSERT_GT(blocks.size(), 1u);
+
+    size_t longest = 0;
+    std::vector<uint8_t> reconstructed;
+    for (const auto& block : blocks) {
+        std::string line = toLogLine(block);
+        EXPECT_LE(line.size(), limit);
+        longest = std::max(longest, line.size());
+        reconstructed.insert(reconstructed.end(), block.data.begin(), block.data.end());
+    }
+    // 分片大小取最大值，最长的行与上限最多相差一个十六进制字符
+    EXPECT_GE(longest + 1, limit);
+    EXPECT_EQ(reconstructed, data);
+
+    // 关闭后恢复使用 maxChunkSize
+    encoder.setMaxLineLength(0);
+    EXPECT_EQ(encoder.encode("image", data, 1000).size(), 5u);
+}
+
+TEST_F(EncoderTest, Encode_MaxLineLengthTooSmall_Throws) {
+    std::vector<uint8_t> data(10, 0x42);
+    encoder.setMaxLineLength(20);
+    EXPECT_THROW(encoder.encode("test", data), std::invalid_argument);
+}
+
+TEST_F(EncoderTest, Encode_ZeroChunkSize_Throws) {
+    std::vector<uint8_t> data(10, 0x42);
+    EXPECT_THROW(encoder.encode("test", data, 0), std::invalid_argument);
+
+    // 设置了行长度上限时忽略 maxChunkSize
+    encoder.setMaxLineLength(200);
+    EXPECT_EQ(encoder.encode("test", data, 0).size(), 1u);
+}
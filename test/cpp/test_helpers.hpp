@@ -0,0 +1,27 @@
+#ifndef RICHLOG_TEST_HELPERS_HPP
+#define RICHLOG_TEST_HELPERS_HPP
+
+#include "richlog.hpp"
+#include "scanner.hpp"
+#include <string>
+
+namespace richlog {
+
+/**
+ * @brief 测试日志中 RICHLOG: 之前的前缀（时间戳和分隔空格）
+ */
+inline const std::string kTestLinePrefix = "[2023-08-15 10:00:01.236] ";
+
+/**
+ * @brief 按日志框架的输出格式生成数据块对应的日志行，不含换行符
+ */
+inline std::string toLogLine(const RichLogBlock& block) {
+    std::string line = kTestLinePrefix + "RICHLOG:" + block.type + "," + block.uuid + "," +
+                       std::to_string(block.index) + "," + std::to_string(block.total) + ",";
+    appendHex(line, block.data.data(), block.data.size());
+    return line;
+}
+
+} // namespace richlog
+
+#endif // RICHLOG_TEST_HELPERS_HPP
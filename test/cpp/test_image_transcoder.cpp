@@ -0,0 +1,399 @@
+#include <gtest/gtest.h>
+#include "image_transcoder.hpp"
+#include "richlog.hpp"
+#include "thread_pool.hpp"
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace richlog;
+
+namespace {
+
+// 读取固定霍夫曼编码的 deflate 流（转码器只输出这种块）
+class FixedInflater {
+public:
+    explicit FixedInflater(const std::vector<uint8_t>& data) : data_(data) {}
+
+    bool inflate(std::vector<uint8_t>& out) {
+        bool final = false;
+        while (!final) {
+            final = readBits(1) == 1;
+            if (readBits(2) != 1) {
+                return false;
+            }
+            while (true) {
+                uint32_t symbol = readSymbol();
+                if (symbol < 256) {
+                    out.push_back(static_cast<uint8_t>(symbol));
+                } else if (symbol == 256) {
+                    break;
+                } else {
+                    static const uint16_t lengthBase[29] = {
+                        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+                    static const uint8_t lengthExtra[29] = {
+                        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+                    static const uint16_t distanceBase[30] = {
+                        1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+                    static const uint8_t distanceExtra[30] = {
+                        0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+                    uint32_t code = symbol - 257;
+                    if (code >= 29) {
+                        return false;
+                    }
+                    size_t length = lengthBase[code] + readBits(lengthExtra[code]);
+                    uint32_t distanceCode = readReversed(5);
+                    if (distanceCode >= 30) {
+                        return false;
+                    }
+                    size_t distance = distanceBase[distanceCode] + readBits(distanceExtra[distanceCode]);
+                    if (distance > out.size()) {
+                        return false;
+                    }
+                    for (size_t i = 0; i < length; ++i) {
+                        out.push_back(out[out.size() - distance]);
+                    }
+                }
+                if (pos_ > data_.size()) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    uint32_t readBits(unsigned count) {
+        uint32_t value = 0;
+        for (unsigned i = 0; i < count; ++i, ++bit_) {
+            size_t byte = bit_ / 8;
+            pos_ = byte;
+            uint32_t bit = byte < data_.size() ? (data_[byte] >> (bit_ % 8)) & 1 : 0;
+            value |= bit << i;
+        }
+        return value;
+    }
+
+    uint32_t readReversed(unsigned count) {
+        uint32_t value = 0;
+        for (unsigned i = 0; i < count; ++i) {
+            value = (value << 1) | readBits(1);
+        }
+        return value;
+    }
+
+    uint32_t readSymbol() {
+        uint32_t code = readReversed(7);
+        if (code <= 0x17) {
+            return 256 + code;
+        }
+        code = (code << 1) | readBits(1);
+        if (code >= 0x30 && code <= 0xBF) {
+            return code - 0x30;
+        }
+        if (code >= 0xC0 && code <= 0xC7) {
+            return 280 + code - 0xC0;
+        }
+        code = (code << 1) | readBits(1);
+        return 144 + code - 0x190;
+    }
+
+    const std::vector<uint8_t>& data_;
+    size_t bit_ = 0;
+    size_t pos_ = 0;
+};
+
+uint32_t readUint32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+uint32_t crc32(const uint8_t* data, size_t size) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= data[i];
+        for (int k = 0; k < 8; ++k) {
+            crc = (crc & 1) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+        }
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+int paeth(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    return (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+}
+
+// 解码 PNG 为原始图像，校验各块 CRC、zlib 头和 Adler-32
+bool decodePng(const std::vector<uint8_t>& png, RawImage& image) {
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    if (png.size() < 8 || std::memcmp(png.data(), signature, 8) != 0) {
+        return false;
+    }
+
+    std::vector<uint8_t> zlib;
+    bool ended = false;
+    for (size_t pos = 8; pos < png.size() && !ended;) {
+        if (pos + 12 > png.size()) {
+            return false;
+        }
+        uint32_t length = readUint32(&png[pos]);
+        if (pos + 12 + length > png.size()) {
+            return false;
+        }
+        std::string type(reinterpret_cast<const char*>(&png[pos + 4]), 4);
+        const uint8_t* body = &png[pos + 8];
+        if (crc32(&png[pos + 4], length + 4) != readUint32(body + length)) {
+            return false;
+        }
+        if (type == "IHDR") {
+            image.width = readUint32(body);
+            image.height = readUint32(body + 4);
+            image.channels = body[9] == 6 ? 4 : 3;
+        } else if (type == "IDAT") {
+            zlib.insert(zlib.end(), body, body + length);
+        } else if (type == "IEND") {
+            ended = true;
+        }
+        pos += 12 + length;
+    }
+    if (!ended || zlib.size() < 6 || ((zlib[0] << 8) | zlib[1]) % 31 != 0) {
+        return false;
+    }
+
+    std::vector<uint8_t> deflate(zlib.begin() + 2, zlib.end() - 4);
+    std::vector<uint8_t> raw;
+    if (!FixedInflater(deflate).inflate(raw)) {
+        return false;
+    }
+    uint32_t a = 1, b = 0;
+    for (uint8_t byte : raw) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    if (((b << 16) | a) != readUint32(&zlib[zlib.size() - 4])) {
+        return false;
+    }
+
+    size_t rowSize = static_cast<size_t>(image.width) * image.channels;
+    if (raw.size() != (rowSize + 1) * image.height) {
+        return false;
+    }
+    image.pixels.assign(rowSize * image.height, 0);
+    for (size_t y = 0; y < image.height; ++y) {
+        uint8_t filter = raw[y * (rowSize + 1)];
+        const uint8_t* in = &raw[y * (rowSize + 1) + 1];
+        uint8_t* out = &image.pixels[y * rowSize];
+        const uint8_t* up = y > 0 ? out - rowSize : nullptr;
+        for (size_t i = 0; i < rowSize; ++i) {
+            int left = i >= image.channels ? out[i - image.channels] : 0;
+            int above = up ? up[i] : 0;
+            int upLeft = (up && i >= image.channels) ? up[i - image.channels] : 0;
+            int predicted = 0;
+            switch (filter) {
+                case 0: break;
+                case 1: predicted = left; break;
+                case 2: predicted = above; break;
+                case 3: predicted = (left + above) / 2; break;
+                case 4: predicted = paeth(left, above, upLeft); break;
+                default: return false;
+            }
+            out[i] = static_cast<uint8_t>(in[i] + predicted);
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+class ImageTranscoderTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // 与日志生成器相同的 200x100 渐变 BMP
+        bmp = makeBmp(200, 100, [](uint32_t x, uint32_t y) {
+            return std::vector<uint8_t>{static_cast<uint8_t>(255 * x / 200),
+                                        static_cast<uint8_t>(255 * y / 100), 128};
+        });
+    }
+
+    template <typename PixelFunc>
+    static std::vector<uint8_t> makeBmp(uint32_t width, uint32_t height, PixelFunc pixelBgr) {
+        uint32_t stride = (width * 3 + 3) / 4 * 4;
+        std::vector<uint8_t> data(54 + stride * height, 0);
+        auto put = [&data](size_t pos, uint32_t value) {
+            for (int i = 0; i < 4; ++i) {
+                data[pos + i] = static_cast<uint8_t>(value >> (8 * i));
+            }
+        };
+        data[0] = 'B';
+        data[1] = 'M';
+        put(2, static_cast<uint32_t>(data.size()));
+        put(10, 54);
+        put(14, 40);
+        put(18, width);
+        put(22, height);
+        data[26] = 1;
+        data[28] = 24;
+        for (uint32_t y = 0; y < height; ++y) {
+            for (uint32_t x = 0; x < width; ++x) {
+                auto bgr = pixelBgr(x, y);
+                // 自下而上存储
+                std::copy(bgr.begin(), bgr.end(), data.begin() + 54 + (height - 1 - y) * stride + x * 3);
+            }
+        }
+        return data;
+    }
+
+    // BMP 第 (x, y) 像素的 RGB 值（y 自上而下）
+    static std::vector<uint8_t> bmpPixel(const std::vector<uint8_t>& data, uint32_t x, uint32_t y) {
+        uint32_t width = data[18] | (data[19] << 8);
+        uint32_t height = data[22] | (data[23] << 8);
+        uint32_t stride = (width * 3 + 3) / 4 * 4;
+        const uint8_t* p = &data[54 + (height - 1 - y) * stride + x * 3];
+        return {p[2], p[1], p[0]};
+    }
+
+    static ByteSink collect(std::vector<uint8_t>& out) {
+        return [&out](const uint8_t* data, size_t size) { out.insert(out.end(), data, data + size); };
+    }
+
+    std::vector<uint8_t> bmp;
+};
+
+TEST_F(ImageTranscoderTest, TranscodeBmp_GradientImage_LosslessAndSmaller) {
+    std::vector<uint8_t> png;
+    ASSERT_TRUE(transcodeBmpToPng(bmp, collect(png)));
+    EXPECT_LT(png.size() * 4, bmp.size());
+
+    RawImage image;
+    ASSERT_TRUE(decodePng(png, image));
+    ASSERT_EQ(image.width, 200u);
+    ASSERT_EQ(image.height, 100u);
+    ASSERT_EQ(image.channels, 3u);
+    for (uint32_t y = 0; y < image.height; ++y) {
+        for (uint32_t x = 0; x < image.width; ++x) {
+            auto expected = bmpPixel(bmp, x, y);
+            const uint8_t* actual = &image.pixels[(y * image.width + x) * 3];
+            ASSERT_EQ(std::vector<uint8_t>(actual, actual + 3), expected) << x << "," << y;
+        }
+    }
+}
+
+TEST_F(ImageTranscoderTest, EncodePng_LargeRgbaFrame_RoundTrips) {
+    // 超过一个压缩段（64KB），覆盖跨段匹配窗口
+    RawImage frame;
+    frame.width = 320;
+    frame.height = 120;
+    frame.channels = 4;
+    uint32_t state = 12345;
+    for (uint32_t y = 0; y < frame.height; ++y) {
+        for (uint32_t x = 0; x < frame.width; ++x) {
+            state = state * 1103515245u + 12345u;
+            frame.pixels.push_back(static_cast<uint8_t>(x));
+            frame.pixels.push_back(static_cast<uint8_t>(y * 2));
+            frame.pixels.push_back(static_cast<uint8_t>((x / 16) % 2 ? 200 : (state >> 24)));
+            frame.pixels.push_back(255);
+        }
+    }
+
+    std::vector<uint8_t> png;
+    ASSERT_TRUE(encodePng(frame, collect(png)));
+    RawImage decoded;
+    ASSERT_TRUE(decodePng(png, decoded));
+    EXPECT_EQ(decoded.channels, 4u);
+    EXPECT_EQ(decoded.pixels, frame.pixels);
+}
+
+TEST_F(ImageTranscoderTest, IsBmpImage_UnsupportedInput_ReturnsFalse) {
+    EXPECT_TRUE(isBmpImage(bmp));
+
+    auto truncated = bmp;
+    truncated.resize(truncated.size() - 1);
+    EXPECT_FALSE(isBmpImage(truncated));
+
+    auto compressed = bmp;
+    compressed[30] = 1;     // BI_RLE8
+    EXPECT_FALSE(isBmpImage(compressed));
+
+    std::vector<uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    EXPECT_FALSE(isBmpImage(png));
+    EXPECT_FALSE(transcodeBmpToPng(png, [](const uint8_t*, size_t) { FAIL(); }));
+}
+
+TEST_F(ImageTranscoderTest, Stage_Encode_BmpBecomesPngBlocks) {
+    RichLogEncoder encoder;
+    ThreadPool pool(2);
+    ImageTranscodeStage stage(encoder, pool);
+
+    auto blocks = stage.encode("image", bmp, 512).get();
+    ASSERT_FALSE(blocks.empty());
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        EXPECT_EQ(blocks[i].type, "image");
+        EXPECT_EQ(blocks[i].uuid, blocks[0].uuid);
+        EXPECT_EQ(blocks[i].index, i + 1);
+        EXPECT_EQ(blocks[i].total, blocks.size());
+        EXPECT_LE(blocks[i].data.size(), 512u);
+    }
+
+    RichLogDecoder decoder;
+    auto png = decoder.decode(blocks);
+    RawImage image;
+    ASSERT_TRUE(decodePng(png, image));
+    EXPECT_EQ(image.width, 200u);
+    EXPECT_LT(blocks.size() * 4, encoder.encode("image", bmp, 512).size());
+}
+
+TEST_F(ImageTranscoderTest, Stage_Encode_NonImageAndNoise_KeepsOriginalData) {
+    RichLogEncoder encoder;
+    ThreadPool pool(1);
+    ImageTranscodeStage stage(encoder, pool);
+    RichLogDecoder decoder;
+
+    std::vector<uint8_t> text = {'h', 'e', 'l', 'l', 'o'};
+    EXPECT_EQ(decoder.decode(stage.encode("config", text).get()), text);
+
+    // 随机噪声压缩后不会变小，退回原始 BMP
+    uint32_t state = 7;
+    auto noise = makeBmp(64, 64, [&state](uint32_t, uint32_t) {
+        state = state * 1103515245u + 12345u;
+        return std::vector<uint8_t>{static_cast<uint8_t>(state >> 24), static_cast<uint8_t>(state >> 16),
+                                    static_cast<uint8_t>(state >> 8)};
+    });
+    EXPECT_EQ(decoder.decode(stage.encode("image", noise, 1000).get()), noise);
+}
+
+TEST_F(ImageTranscoderTest, Stage_EncodeFrame_InvalidFrame_Throws) {
+    RichLogEncoder encoder;
+    ThreadPool pool(1);
+    ImageTranscodeStage stage(encoder, pool);
+
+    RawImage frame;
+    frame.width = 4;
+    frame.height = 4;
+    frame.pixels.resize(10);
+    auto future = stage.encodeFrame("image", frame);
+    EXPECT_THROW(future.get(), std::invalid_argument);
+}
+
+TEST_F(ImageTranscoderTest, Stage_Encode_UnboundedChunkSize_SingleBlock) {
+    RichLogEncoder encoder;
+    ThreadPool pool(1);
+    ImageTranscodeStage stage(encoder, pool);
+    RichLogDecoder decoder;
+
+    // SIZE_MAX 表示不分片，不能按 maxChunkSize 预留内存
+    auto blocks = stage.encode("image", bmp, SIZE_MAX).get();
+    ASSERT_EQ(blocks.size(), 1u);
+    RawImage image;
+    ASSERT_TRUE(decodePng(decoder.decode(blocks), image));
+    EXPECT_EQ(image.width, 200u);
+
+    EXPECT_THROW(stage.encode("image", bmp, 0), std::invalid_argument);
+}
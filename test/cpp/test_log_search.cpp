@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include "log_search.hpp"
+#include "thread_pool.hpp"
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace richlog;
+
+class LogSearchTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        for (int i = 0; i < 200; ++i) {
+            std::string ts = "[2023-08-15 10:00:" + std::to_string(10 + i % 50) + ".236] ";
+            switch (i % 5) {
+                case 0: text += ts + "INFO: User login successful\n"; break;
+                case 1: text += ts + "RICHLOG:config,5f35c0af,1,1,7b0a7d\n"; break;
+                case 2: text += ts + "DEBUG: Request 5f35c0af processed\n"; break;
+                case 3: text += ts + "RICHLOG:image,ad3acbe4," + std::to_string(i / 5 + 1) + ",40,89504e47\r\n"; break;
+                default: text += ts + "WARN: Memory usage: 45%\n"; break;
+            }
+        }
+        text += "[2023-08-15 10:00:59.999] INFO: last line without newline RICHLOG:command,8b31b4cf,1,1,46";
+    }
+
+    // 逐行过滤的参考结果
+    std::vector<size_t> expectedLines(const SearchQuery& query) const {
+        LogSearcher searcher(query);
+        std::vector<size_t> lines;
+        size_t start = 0;
+        size_t number = 1;
+        while (start <= text.size()) {
+            size_t end = text.find('\n', start);
+            if (end == std::string::npos) {
+                end = text.size();
+            }
+            if (searcher.matchesLine(std::string_view(text).substr(start, end - start))) {
+                lines.push_back(number);
+            }
+            start = end + 1;
+            ++number;
+        }
+        return lines;
+    }
+
+    std::vector<size_t> searchLines(const SearchQuery& query, size_t rangeSize) {
+        std::vector<size_t> lines;
+        for (const auto& match : LogSearcher(query).search(pool, text, rangeSize)) {
+            EXPECT_EQ(std::string_view(text).substr(match.offset, match.line.size()), match.line);
+            lines.push_back(match.lineNumber);
+        }
+        return lines;
+    }
+
+    ThreadPool pool{4};
+    std::string text;
+};
+
+TEST_F(LogSearchTest, Search_AnyRangeSize_MatchesLineByLineFilter) {
+    std::vector<SearchQuery> queries(6);
+    queries[0].literals = {"5f35c0af"};
+    queries[1].literals = {"WARN", "login", "no such text"};
+    queries[2].type = "image";
+    queries[3].uuid = "5f35c0af";
+    queries[4].richlogOnly = true;
+    queries[5].literals = {"10:00:1"};
+    queries[5].type = "config";
+
+    for (const auto& query : queries) {
+        auto expected = expectedLines(query);
+        ASSERT_FALSE(expected.empty());
+        for (size_t rangeSize : {1u, 37u, 500u, 1u << 20}) {
+            EXPECT_EQ(searchLines(query, rangeSize), expected) << rangeSize;
+        }
+    }
+}
+
+TEST_F(LogSearchTest, Search_TypeAndUuid_OnlyRichLogLines) {
+    SearchQuery query;
+    query.uuid = "5f35c0af";
+    auto matches = LogSearcher(query).search(pool, text, 100);
+    ASSERT_EQ(matches.size(), 40u);   // DEBUG 行中的同名文本不算
+    EXPECT_EQ(matches[0].lineNumber, 2u);
+
+    query = SearchQuery();
+    query.type = "command";
+    matches = LogSearcher(query).search(pool, text);
+    ASSERT_EQ(matches.size(), 1u);
+    EXPECT_EQ(matches[0].lineNumber, 201u);
+}
+
+TEST_F(LogSearchTest, Search_EmptyQuery_ReturnsAllLines) {
+    auto matches = LogSearcher(SearchQuery()).search(pool, text, 64);
+    ASSERT_EQ(matches.size(), 201u);
+    EXPECT_EQ(matches.back().line.substr(0, 5), "[2023");
+    EXPECT_TRUE(LogSearcher(SearchQuery()).search(pool, "").empty());
+}
+
+TEST_F(LogSearchTest, Constructor_NewlineInLiteral_Throws) {
+    SearchQuery query;
+    query.literals = {"a\nb"};
+    EXPECT_THROW(LogSearcher searcher(query), std::invalid_argument);
+}
+
+TEST_F(LogSearchTest, MappedFile_Open_ReadsContent) {
+    std::string path = ::testing::TempDir() + "richlog_search_test.log";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << text;
+    }
+
+    MappedFile file;
+    ASSERT_TRUE(file.open(path));
+    EXPECT_EQ(file.view(), text);
+    file.close();
+    EXPECT_EQ(file.size(), 0u);
+    std::remove(path.c_str());
+
+    EXPECT_FALSE(file.open(path));
+}
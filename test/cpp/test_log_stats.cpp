@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include "log_stats.hpp"
+#include "thread_pool.hpp"
+#include <string>
+#include <vector>
+
+using namespace richlog;
+
+class LogStatsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        const std::string ts = "[2023-08-15 10:00:01.236] ";
+        addLine(ts + "INFO: User login successful");
+        addLine(ts + "RICHLOG:config,c1,1,1,7b7d");
+        addLine(ts + "RICHLOG:image,i1,1,3,00112233");
+        std::string hex;
+        for (int i = 0; i < 1024; ++i) {
+            hex += "ab";
+        }
+        addLine(ts + "RICHLOG:config,c2,1,1," + hex);
+        addLine(ts + "RICHLOG:image,i1,2,3,4455");
+        incompleteOffset = text.size();
+        addLine(ts + "RICHLOG:image,i2,1,3,ff");
+        addLine(ts + "RICHLOG:image,i1,2,3,4455");    // 重复分片
+        invalidOffset = text.size();
+        addLine(ts + "RICHLOG:command,x1,5,2,00");    // 索引超过总数
+        text += ts + "RICHLOG:broken,1\n";            // 无法解析
+        addLine(ts + "RICHLOG:config,r1,0,0,00000000"); // 去重引用
+        addLine(ts + "RICHLOG:image,i1,3,3,66\r");
+        text += "RICHLOG:command,x2,1,1,46";          // 最后一行没有换行符
+        richlogBytes += 25;
+    }
+
+    void addLine(const std::string& line) {
+        text += line + "\n";
+        if (line.find("RICHLOG:") != std::string::npos) {
+            richlogBytes += line.size();
+        }
+    }
+
+    ThreadPool pool{4};
+    std::string text;
+    size_t richlogBytes = 0;
+    size_t incompleteOffset = 0;
+    size_t invalidOffset = 0;
+};
+
+TEST_F(LogStatsTest, Collect_MixedLog_CountsPerType) {
+    LogStats stats = LogStatsCollector().collect(pool, text);
+
+    EXPECT_EQ(stats.bytes, text.size());
+    EXPECT_EQ(stats.richlogLines, 10u);
+    EXPECT_EQ(stats.invalidLines, 1u);
+    ASSERT_EQ(stats.types.size(), 3u);
+
+    const TypeStats& config = stats.types.at("config");
+    EXPECT_EQ(config.payloads, 2u);
+    EXPECT_EQ(config.completePayloads, 2u);
+    EXPECT_EQ(config.references, 1u);
+    EXPECT_EQ(config.chunks, 3u);
+    EXPECT_EQ(config.payloadBytes, 1026u);
+    EXPECT_EQ(config.maxPayloadBytes, 1024u);
+    EXPECT_EQ(config.payloadSizes.buckets[2], 1u);    // 2 字节
+    EXPECT_EQ(config.payloadSizes.buckets[11], 1u);   // 1024 字节
+
+    const TypeStats& image = stats.types.at("image");
+    EXPECT_EQ(image.payloads, 2u);
+    EXPECT_EQ(image.completePayloads, 1u);
+    EXPECT_EQ(image.incompletePayloads, 1u);
+    EXPECT_EQ(image.chunks, 5u);
+    EXPECT_EQ(image.duplicateChunks, 1u);
+    EXPECT_EQ(image.payloadBytes, 8u);
+    EXPECT_EQ(image.chunksPerPayload.buckets[2], 1u); // 3 个分片
+    ASSERT_EQ(image.samples.size(), 1u);
+    EXPECT_EQ(image.samples[0].uuid, "i2");
+    EXPECT_EQ(image.samples[0].offset, incompleteOffset);
+    EXPECT_EQ(image.samples[0].received, 1u);
+    EXPECT_EQ(image.samples[0].total, 3u);
+    EXPECT_FALSE(image.samples[0].invalid);
+
+    const TypeStats& command = stats.types.at("command");
+    EXPECT_EQ(command.payloads, 2u);
+    EXPECT_EQ(command.completePayloads, 1u);
+    EXPECT_EQ(command.invalidPayloads, 1u);
+
+    EXPECT_EQ(stats.total.payloads, 6u);
+    EXPECT_EQ(stats.total.completePayloads, 4u);
+    EXPECT_EQ(stats.total.chunks, stats.richlogLines);
+    EXPECT_EQ(stats.total.encodedBytes, richlogBytes);
+    ASSERT_EQ(stats.total.samples.size(), 2u);
+    EXPECT_EQ(stats.total.samples[0].offset, incompleteOffset);
+    EXPECT_EQ(stats.total.samples[1].offset, invalidOffset);
+    EXPECT_TRUE(stats.total.samples[1].invalid);
+}
+
+TEST_F(LogStatsTest, Collect_AnyRangeSize_SameResult) {
+    // 同一载荷的分片落在不同区间时结果不变
+    for (int copy = 0; copy < 20; ++copy) {
+        text += "\n[2023-08-15 10:00:02.000] RICHLOG:image,k" + std::to_string(copy) + ",2,2,0102";
+        text += "\n[2023-08-15 10:00:02.000] RICHLOG:image,k" + std::to_string(copy) + ",1,2,03";
+    }
+    LogStatsCollector collector(3);
+    std::string expected = formatLogStatsJson(collector.collect(pool, text), "test.log");
+    for (size_t rangeSize : {1, 7, 64, 500}) {
+        EXPECT_EQ(formatLogStatsJson(collector.collect(pool, text, rangeSize), "test.log"), expected)
+            << "rangeSize=" << rangeSize;
+    }
+    EXPECT_EQ(collector.collect(pool, text).types.at("image").completePayloads, 21u);
+}
+
+TEST_F(LogStatsTest, Collect_DuplicatesAcrossRanges_CountFirstCopyOnly) {
+    // 分片大小不一致，重复副本的长度与第一份不同，且分布在不同区间
+    std::string log = "RICHLOG:blob,m1,2,4,0011\n"
+                      "RICHLOG:blob,m1,4,4,223344\n"
+                      "RICHLOG:blob,m1,1,4,55\n"
+                      "RICHLOG:blob,m1,2,4,66778899\n"   // 重复，长度不同
+                      "RICHLOG:blob,m1,3,4,aabbccdd\n"
+                      "RICHLOG:blob,m1,4,4,ee\n";        // 重复，长度不同
+    LogStatsCollector collector;
+    for (size_t rangeSize : {1, 30, 1 << 20}) {
+        const TypeStats& blob = collector.collect(pool, log, rangeSize).types.at("blob");
+        EXPECT_EQ(blob.completePayloads, 1u) << "rangeSize=" << rangeSize;
+        EXPECT_EQ(blob.duplicateChunks, 2u) << "rangeSize=" << rangeSize;
+        EXPECT_EQ(blob.payloadBytes, 10u) << "rangeSize=" << rangeSize;
+        EXPECT_EQ(blob.maxPayloadBytes, 10u) << "rangeSize=" << rangeSize;
+    }
+}
+
+TEST_F(LogStatsTest, FormatLogStatsJson_ContainsRatesHistogramsAndSamples) {
+    std::string json = formatLogStatsJson(LogStatsCollector().collect(pool, text), "a \"b\".log");
+
+    EXPECT_NE(json.find("\"path\": \"a \\\"b\\\".log\""), std::string::npos);
+    EXPECT_NE(json.find("\"invalidLineRate\": 0.090909"), std::string::npos);
+    EXPECT_NE(json.find("\"incompleteRate\": 0.500000"), std::string::npos);
+    EXPECT_NE(json.find("{\"min\": 1024, \"max\": 2047, \"count\": 1}"), std::string::npos);
+    EXPECT_NE(json.find("{\"uuid\": \"x1\", \"offset\": " + std::to_string(invalidOffset) +
+                        ", \"received\": 0, \"total\": 2, \"reason\": \"invalid\"}"),
+              std::string::npos);
+    EXPECT_EQ(json.front(), '{');
+    EXPECT_EQ(json.back(), '}');
+
+    EXPECT_NE(formatLogStatsJson(LogStats(), "empty.log").find("\"types\": {}"), std::string::npos);
+}
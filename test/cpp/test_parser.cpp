@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 #include "richlog.hpp"
+#include "scanner.hpp"
 #include <string>
+#include <vector>
 
 using namespace richlog;
 
@@ -82,3 +84,82 @@ TEST_F(ParserTest, Parse_HexData_ConvertsCorrectly) {
     std::string actual(block->data.begin(), block->data.end());
     EXPECT_EQ(actual, expected);
 }
+
+class FastParserTest : public ::testing::Test {
+protected:
+    RichLogParser reference;
+    FastRichLogParser parser;
+};
+
+TEST_F(FastParserTest, Parse_MatchesReferenceParser) {
+    std::vector<std::string> lines = {
+        "[2023-08-15 10:00:01.236] RICHLOG:config,c9a3a0ad,1,1,7b22736572766572223a7b",
+        "[2023-08-15 10:15:30.533] RICHLOG:image,e5f6g7h8,1,2,FFD8FFE000104A4649",
+        "[2023-08-15 10:00:01.236] RICHLOG:test,abc123,1,1,48656C6C6F",
+        "[2023-08-15 10:00:01.236] RICHLOG:test,abc123,1,1,48656C6C6",       // 奇数长度
+        "[2023-08-15 10:00:01.236] RICHLOG:test,abc123,1,1,4865zz",          // 十六进制后有尾随字符
+        "[2023-08-15 10:00:01.236] RICHLOG:config,c9a3a0ad,1,1",
+        "[2023-08-15 10:00:01.236] RICHLOG:,abc123,1,1,48",
+        "[2023-08-15 10:00:01.236] RICHLOG:test,abc123,x,1,48",
+        "[2023-08-15 10:00:01.236] INFO: This is a normal log message",
+        "RICHLOG:bad,1 RICHLOG:test,abc123,2,3,4142",
+    };
+
+    for (const auto& line : lines) {
+        auto expected = reference.parse(line);
+        auto actual = parser.parse(line);
+        ASSERT_EQ(expected == nullptr, actual == nullptr) << line;
+        EXPECT_EQ(parser.isRichLogFormat(line), reference.isRichLogFormat(line)) << line;
+        if (expected) {
+            EXPECT_EQ(actual->type, expected->type) << line;
+            EXPECT_EQ(actual->uuid, expected->uuid) << line;
+            EXPECT_EQ(actual->index, expected->index) << line;
+            EXPECT_EQ(actual->total, expected->total) << line;
+            EXPECT_EQ(actual->data, expected->data) << line;
+        }
+    }
+}
+
+TEST_F(FastParserTest, ScanRichLogLine_SkipsMarkerThatFailsToMatch) {
+    RichLogLineView view;
+    ASSERT_TRUE(scanRichLogLine("RICHLOG:bad,1 RICHLOG:test,abc123,2,3,4142", view));
+
+    EXPECT_EQ(view.type, "test");
+    EXPECT_EQ(view.uuid, "abc123");
+    EXPECT_EQ(view.index, 2u);
+    EXPECT_EQ(view.total, 3u);
+    EXPECT_EQ(view.hex, "4142");
+}
+
+TEST_F(FastParserTest, ScanRichLogLine_IndexOverflow_ReturnsFalse) {
+    RichLogLineView view;
+    EXPECT_FALSE(scanRichLogLine("RICHLOG:test,abc123,4294967296,1,41", view));
+    EXPECT_TRUE(scanRichLogLine("RICHLOG:test,abc123,4294967295,1,41", view));
+}
+
+TEST_F(FastParserTest, ReferenceParser_IndexOverflow_SkipsToNextMarker) {
+    auto block = reference.parse("RICHLOG:test,abc123,4294967296,1,41 RICHLOG:test,abc123,1,1,42");
+    ASSERT_NE(block, nullptr);
+    EXPECT_EQ(block->index, 1u);
+    EXPECT_EQ(block->data, std::vector<uint8_t>({0x42}));
+
+    EXPECT_EQ(reference.parse("RICHLOG:test,abc123,1,99999999999999999999999,41"), nullptr);
+}
+
+TEST_F(FastParserTest, Hex_RoundTrip) {
+    std::vector<uint8_t> data;
+    for (int i = 0; i < 256; ++i) {
+        data.push_back(static_cast<uint8_t>(i));
+    }
+
+    std::string hex;
+    appendHex(hex, data.data(), data.size());
+    EXPECT_EQ(hex.substr(0, 8), "00010203");
+
+    std::vector<uint8_t> decoded;
+    EXPECT_TRUE(decodeHex(hex, decoded));
+    EXPECT_EQ(decoded, data);
+
+    std::vector<uint8_t> invalid;
+    EXPECT_FALSE(decodeHex("4g", invalid));
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include "parser_harness.hpp"
+#include "scanner.hpp"
+#include <string>
+#include <vector>
+
+using namespace richlog;
+
+class ParserHarnessTest : public ::testing::Test {
+protected:
+    ParserDiffHarness harness;
+};
+
+TEST_F(ParserHarnessTest, Compare_EdgeCases_AllImplementationsAgree) {
+    std::string longHex;
+    for (int i = 0; i < 100; ++i) {
+        longHex += "0123456789abcdefABCDEF"[i % 22];
+    }
+    std::vector<std::string> lines = {
+        "RICHLOG:test,abc123,1,1," + longHex,
+        "RICHLOG:test,abc123,1,1," + longHex + "g",
+        "RICHLOG:test,abc123,1,1," + longHex.substr(0, 33),
+        "[2023-08-15 10:00:01.236] RICHLOG:config,c9a3a0ad,1,1,7b22",
+        "RICHLOG:test,abc123,4294967296,1,41 RICHLOG:test,abc123,1,1,42",
+        "RICHLOG:test,abc123,1,99999999999999999999999,41",
+        "RICHLOG:test,abc123,4294967295,4294967295,41",
+        "RICHLOG:RICHLOG:a,b,1,1,ff",
+        "RICHLOG:bad,1 RICHLOG:test,abc123,2,3,4142",
+        std::string("RICHLOG:t\0e,u\x80\xff,1,1,41\0", 24),
+        "RICHLOG:test,abc123,1,1,",
+        "RICHLOG:test,abc123,,1,41",
+        "RICHLOG:,abc123,1,1,41",
+        "xxxxxxxxxxxxxxxxxxxxxxxxxxxxRICHLOG",
+        "xxxxxxxxxxxxxxxxxxxxxxxxxxxxRICHLOG:a,b,1,1,aF\r",
+        "",
+    };
+
+    for (const auto& line : lines) {
+        std::vector<std::string> results;
+        EXPECT_TRUE(harness.compare(line, &results)) << results[0] << " / " << results[1] << " / " << results[2];
+    }
+}
+
+TEST_F(ParserHarnessTest, Run_GeneratedCorpus_NoDivergence) {
+    auto lines = generateParserCorpus(1000, 7);
+    ASSERT_EQ(lines.size(), 1000u);
+    EXPECT_EQ(generateParserCorpus(1000, 7), lines);
+
+    ParserDiffReport report = harness.run(lines);
+    EXPECT_EQ(report.lines, lines.size());
+    EXPECT_EQ(report.divergenceCount, 0u);
+    EXPECT_TRUE(report.divergences.empty());
+
+    ASSERT_EQ(report.throughput.size(), 3u);
+    EXPECT_EQ(report.throughput[0].name, "reference");
+    // 语料中既有匹配行也有不匹配行
+    EXPECT_GT(report.throughput[0].matched, lines.size() / 4);
+    EXPECT_LT(report.throughput[0].matched, lines.size());
+    for (const auto& entry : report.throughput) {
+        EXPECT_EQ(entry.matched, report.throughput[0].matched);
+    }
+}
+
+TEST_F(ParserHarnessTest, DescribeParseResult_EscapesBytesAsLatin1) {
+    EXPECT_EQ(describeParseResult(nullptr), "null");
+
+    RichLogBlock block(std::string("a\"\\\x01\xe5", 5), "5f35c0af", 1, 2);
+    block.data = {0x7b, 0x0a};
+    EXPECT_EQ(describeParseResult(&block),
+              "{\"type\":\"a\\\"\\\\\\u0001\\u00e5\",\"uuid\":\"5f35c0af\",\"index\":1,\"total\":2,\"data\":\"7b0a\"}");
+}
+
+TEST_F(ParserHarnessTest, ScanRichLogLineSimd_MatchesScalarView) {
+    for (const auto& line : generateParserCorpus(2000, 11)) {
+        RichLogLineView scalar;
+        RichLogLineView simd;
+        bool matched = scanRichLogLine(line, scalar);
+        ASSERT_EQ(scanRichLogLineSimd(line, simd), matched) << line;
+        if (matched) {
+            EXPECT_EQ(simd.type, scalar.type);
+            EXPECT_EQ(simd.uuid, scalar.uuid);
+            EXPECT_EQ(simd.index, scalar.index);
+            EXPECT_EQ(simd.total, scalar.total);
+            EXPECT_EQ(simd.hex.data(), scalar.hex.data());
+            EXPECT_EQ(simd.hex.size(), scalar.hex.size());
+        }
+    }
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include "payload_reader.hpp"
+#include "richlog.hpp"
+#include "test_helpers.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace richlog;
+
+class PayloadReaderTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        for (size_t i = 0; i < 1000; ++i) {
+            data.push_back(static_cast<uint8_t>(i * 31 + 7));
+        }
+        blocks = encoder.encode("image", data, 64);
+        uuid = blocks[0].uuid;
+    }
+
+    std::vector<uint8_t> slice(size_t offset, size_t length) const {
+        size_t end = std::min(offset + length, data.size());
+        return std::vector<uint8_t>(data.begin() + offset, data.begin() + end);
+    }
+
+    RichLogEncoder encoder;
+    PayloadReader reader;
+    std::vector<uint8_t> data;
+    std::vector<RichLogBlock> blocks;
+    std::string uuid;
+};
+
+TEST_F(PayloadReaderTest, Read_RangesMatchOriginalData) {
+    for (const auto& block : blocks) {
+        EXPECT_TRUE(reader.addLine(toLogLine(block)));
+    }
+
+    EXPECT_TRUE(reader.isComplete(uuid));
+    EXPECT_EQ(reader.typeOf(uuid), "image");
+
+    uint64_t size = 0;
+    ASSERT_TRUE(reader.payloadSize(uuid, size));
+    EXPECT_EQ(size, data.size());
+
+    EXPECT_EQ(reader.read(uuid, 0, 16), slice(0, 16));
+    EXPECT_EQ(reader.read(uuid, 60, 10), slice(60, 10));    // 跨分片
+    EXPECT_EQ(reader.read(uuid, 130, 300), slice(130, 300));
+    EXPECT_EQ(reader.read(uuid, 990, 100), slice(990, 100)); // 截断到末尾
+    EXPECT_EQ(reader.read(uuid, 0, data.size()), data);
+    EXPECT_TRUE(reader.read(uuid, 1000, 10).empty());
+    EXPECT_TRUE(reader.read("missing", 0, 10).empty());
+}
+
+TEST_F(PayloadReaderTest, Read_HeadOfIncompletePayload) {
+    // 只收到前两个分片时也能预览开头
+    reader.addLine(toLogLine(blocks[0]));
+    reader.addLine(toLogLine(blocks[1]));
+
+    EXPECT_FALSE(reader.isComplete(uuid));
+    uint64_t size = 0;
+    EXPECT_FALSE(reader.payloadSize(uuid, size));
+
+    EXPECT_EQ(reader.read(uuid, 0, 32), slice(0, 32));
+    EXPECT_EQ(reader.read(uuid, 100, 100), slice(100, 28)); // 在缺失分片处停止
+    EXPECT_TRUE(reader.read(uuid, 500, 10).empty());
+}
+
+TEST_F(PayloadReaderTest, Read_HugeLength_ReadsToEnd) {
+    for (const auto& block : blocks) {
+        reader.addLine(toLogLine(block));
+    }
+    EXPECT_EQ(reader.read(uuid, 10, SIZE_MAX), slice(10, data.size()));
+    EXPECT_TRUE(reader.read(uuid, data.size(), SIZE_MAX).empty());
+
+    // 大小未知的不完整载荷同样读到缺失分片为止
+    PayloadReader partial;
+    partial.addLine(toLogLine(blocks[0]));
+    EXPECT_EQ(partial.read(uuid, 0, SIZE_MAX), slice(0, 64));
+}
+
+TEST_F(PayloadReaderTest, Read_OutOfOrderAndDuplicateLines) {
+    for (auto it = blocks.rbegin(); it != blocks.rend(); ++it) {
+        reader.addLine(toLogLine(*it));
+        reader.addLine(toLogLine(*it));
+    }
+
+    EXPECT_EQ(reader.read(uuid, 0, data.size()), data);
+}
+
+TEST_F(PayloadReaderTest, Read_NonUniformChunks_FallsBackToPrefixSums) {
+    std::vector<RichLogBlock> uneven;
+    size_t sizes[] = {10, 30, 5, 20};
+    size_t offset = 0;
+    for (uint32_t i = 0; i < 4; ++i) {
+        RichLogBlock block("command", "abc123", i + 1, 4);
+        block.data.assign(data.begin() + offset, data.begin() + offset + sizes[i]);
+        offset += sizes[i];
+        uneven.push_back(block);
+    }
+    for (const auto& block : uneven) {
+        reader.addLine(toLogLine(block));
+    }
+
+    uint64_t size = 0;
+    ASSERT_TRUE(reader.payloadSize("abc123", size));
+    EXPECT_EQ(size, 65u);
+    EXPECT_EQ(reader.read("abc123", 8, 30), slice(8, 30));
+    EXPECT_EQ(reader.read("abc123", 42, 100), slice(42, 23));
+}
+
+TEST_F(PayloadReaderTest, AddLine_RejectsInvalidLines) {
+    EXPECT_FALSE(reader.addLine("[2023-08-15 10:00:01.236] INFO: normal message"));
+    EXPECT_FALSE(reader.addLine("RICHLOG:test,abc123,0,1,41"));
+    EXPECT_FALSE(reader.addLine("RICHLOG:test,abc123,3,2,41"));
+    EXPECT_TRUE(reader.addLine("RICHLOG:test,abc123,1,2,41"));
+    EXPECT_FALSE(reader.addLine("RICHLOG:image,abc123,2,2,42"));
+}
+
+TEST_F(PayloadReaderTest, Read_ReferenceLine_ReadsReferencedPayload) {
+    for (const auto& block : blocks) {
+        reader.addLine(toLogLine(block));
+    }
+    std::string referenceLine = "[2023-08-15 10:00:02.000] RICHLOG:image,1a2b3c4d,0,0," + uuid;
+    EXPECT_TRUE(reader.addLine(referenceLine));
+
+    EXPECT_TRUE(reader.isComplete("1a2b3c4d"));
+    EXPECT_EQ(reader.typeOf("1a2b3c4d"), "image");
+    EXPECT_EQ(reader.read("1a2b3c4d", 100, 50), slice(100, 50));
+}
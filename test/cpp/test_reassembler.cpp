@@ -0,0 +1,396 @@
+#include <gtest/gtest.h>
+#include "reassembler.hpp"
+#include "test_helpers.hpp"
+#include "thread_pool.hpp"
+#include <string>
+#include <vector>
+
+using namespace richlog;
+
+namespace {
+
+RichLogBlock makeBlock(const std::string& uuid, uint32_t index, uint32_t total, const std::string& text) {
+    RichLogBlock block("test", uuid, index, total);
+    block.data.assign(text.begin(), text.end());
+    return block;
+}
+
+} // namespace
+
+class ReassemblerTest : public ::testing::Test {
+protected:
+    RichLogEncoder encoder;
+};
+
+TEST_F(ReassemblerTest, Add_OutOfOrderChunks_CompletesInIndexOrder) {
+    ShardedReassembler reassembler;
+
+    EXPECT_TRUE(reassembler.add(makeBlock("abc123", 2, 3, "C1"), 1));
+    EXPECT_TRUE(reassembler.add(makeBlock("abc123", 3, 3, "23"), 2));
+    EXPECT_EQ(reassembler.pendingCount(), 1u);
+    EXPECT_TRUE(reassembler.add(makeBlock("abc123", 1, 3, "AB"), 3));
+
+    auto completed = reassembler.takeCompleted();
+    ASSERT_EQ(completed.size(), 1u);
+    EXPECT_EQ(std::string(completed[0].data.begin(), completed[0].data.end()), "ABC123");
+    EXPECT_EQ(completed[0].uuid, "abc123");
+    EXPECT_EQ(completed[0].sequence, 3u);
+    EXPECT_EQ(reassembler.pendingCount(), 0u);
+    EXPECT_TRUE(reassembler.takeCompleted().empty());
+}
+
+TEST_F(ReassemblerTest, Add_MismatchedTypeOrTotal_IsRejected) {
+    ShardedReassembler reassembler;
+
+    EXPECT_TRUE(reassembler.add(makeBlock("abc123", 1, 2, "AB"), 0));
+
+    RichLogBlock otherType = makeBlock("abc123", 2, 2, "CD");
+    otherType.type = "image";
+    EXPECT_FALSE(reassembler.add(otherType, 1));
+    EXPECT_FALSE(reassembler.add(makeBlock("abc123", 2, 3, "CD"), 2));
+    EXPECT_FALSE(reassembler.add(makeBlock("abc123", 3, 2, "CD"), 3));
+    EXPECT_FALSE(reassembler.add(makeBlock("def456", 0, 1, "CD"), 4));
+
+    EXPECT_TRUE(reassembler.takeCompleted().empty());
+}
+
+TEST_F(ReassemblerTest, Add_DuplicateChunk_FirstWins) {
+    ShardedReassembler reassembler;
+
+    reassembler.add(makeBlock("abc123", 1, 2, "AB"), 0);
+    reassembler.add(makeBlock("abc123", 1, 2, "XX"), 1);
+    reassembler.add(makeBlock("abc123", 2, 2, "CD"), 2);
+
+    auto completed = reassembler.takeCompleted();
+    ASSERT_EQ(completed.size(), 1u);
+    EXPECT_EQ(std::string(completed[0].data.begin(), completed[0].data.end()), "ABCD");
+}
+
+TEST_F(ReassemblerTest, Add_DeterministicOrder_KeepsLowestSequenceDuplicate) {
+    ReassemblerOptions options;
+    options.deterministicOrder = true;
+    ShardedReassembler reassembler(options);
+
+    // 模拟另一个线程先提交了文件后部的重复分片
+    reassembler.add(makeBlock("abc123", 1, 2, "XX"), 10);
+    reassembler.add(makeBlock("abc123", 1, 2, "AB"), 1);
+    reassembler.add(makeBlock("abc123", 2, 2, "CD"), 2);
+
+    auto completed = reassembler.takeCompleted();
+    ASSERT_EQ(completed.size(), 1u);
+    EXPECT_EQ(std::string(completed[0].data.begin(), completed[0].data.end()), "ABCD");
+}
+
+TEST_F(ReassemblerTest, Add_RejectPolicy_RefusesDuplicates) {
+    ReassemblerOptions options;
+    options.duplicatePolicy = DuplicatePolicy::Reject;
+    ShardedReassembler reassembler(options);
+
+    EXPECT_TRUE(reassembler.add(makeBlock("abc123", 1, 2, "AB"), 0));
+    EXPECT_FALSE(reassembler.add(makeBlock("abc123", 1, 2, "AB"), 1));
+    EXPECT_TRUE(reassembler.add(makeBlock("abc123", 2, 2, "CD"), 2));
+
+    auto completed = reassembler.takeCompleted();
+    ASSERT_EQ(completed.size(), 1u);
+    EXPECT_EQ(std::string(completed[0].data.begin(), completed[0].data.end()), "ABCD");
+    EXPECT_EQ(reassembler.stats().duplicateChunks, 1u);
+}
+
+TEST_F(ReassemblerTest, Add_VerifyChecksumConflict_DropsPayload) {
+    ReassemblerOptions options;
+    options.duplicatePolicy = DuplicatePolicy::VerifyChecksum;
+    ShardedReassembler reassembler(options);
+
+    // 多个进程写出了相同的分片，内容一致时正常完成
+    reassembler.add(makeBlock("abc123", 1, 2, "AB"), 0);
+    reassembler.add(makeBlock("abc123", 1, 2, "AB"), 1);
+    reassembler.add(makeBlock("abc123", 2, 2, "CD"), 2);
+    EXPECT_EQ(reassembler.takeCompleted().size(), 1u);
+
+    // uuid 冲突导致同一分片内容不同，整个载荷被丢弃
+    EXPECT_TRUE(reassembler.add(makeBlock("def456", 1, 2, "AB"), 3));
+    EXPECT_TRUE(reassembler.add(makeBlock("def456", 1, 2, "XX"), 4));
+    EXPECT_TRUE(reassembler.add(makeBlock("def456", 2, 2, "CD"), 5));
+    EXPECT_TRUE(reassembler.takeCompleted().empty());
+    EXPECT_EQ(reassembler.pendingCount(), 0u);
+
+    ReassemblerStats stats = reassembler.stats();
+    EXPECT_EQ(stats.duplicateChunks, 2u);
+    EXPECT_EQ(stats.conflictingChunks, 1u);
+    EXPECT_EQ(stats.droppedPayloads, 1u);
+}
+
+TEST_F(ReassemblerTest, Add_DuplicateAfterCompletion_CountedAsDuplicate) {
+    ShardedReassembler reassembler;
+
+    // 单分片载荷被投递两次，只输出一次
+    EXPECT_TRUE(reassembler.add(makeBlock("abc123", 1, 1, "AB"), 0));
+    EXPECT_EQ(reassembler.takeCompleted().size(), 1u);
+    EXPECT_FALSE(reassembler.add(makeBlock("abc123", 1, 1, "AB"), 1));
+
+    // 多分片载荷完成后，其中一个分片迟到的副本不会留下未完成的载荷
+    reassembler.add(makeBlock("def456", 1, 3, "AB"), 2);
+    reassembler.add(makeBlock("def456", 2, 3, "CD"), 3);
+    reassembler.add(makeBlock("def456", 3, 3, "EF"), 4);
+    EXPECT_FALSE(reassembler.add(makeBlock("def456", 2, 3, "CD"), 5));
+
+    auto completed = reassembler.takeCompleted();
+    ASSERT_EQ(completed.size(), 1u);
+    EXPECT_EQ(std::string(completed[0].data.begin(), completed[0].data.end()), "ABCDEF");
+    EXPECT_TRUE(reassembler.takeCompleted().empty());
+    EXPECT_EQ(reassembler.pendingCount(), 0u);
+    EXPECT_EQ(reassembler.stats().duplicateChunks, 2u);
+}
+
+TEST_F(ReassemblerTest, Add_DuplicateAfterFinishedCacheEviction_StartsNewPayload) {
+    ReassemblerOptions options;
+    options.shardCount = 1;
+    options.finishedCacheSize = 1;
+    ShardedReassembler reassembler(options);
+
+    reassembler.add(makeBlock("abc123", 1, 1, "AB"), 0);
+    reassembler.add(makeBlock("def456", 1, 1, "CD"), 1);
+    // abc123 已被淘汰，超出记忆范围的副本只能当作新载荷
+    EXPECT_TRUE(reassembler.add(makeBlock("abc123", 1, 1, "AB"), 2));
+    EXPECT_FALSE(reassembler.add(makeBlock("abc123", 1, 1, "AB"), 3));
+    EXPECT_EQ(reassembler.takeCompleted().size(), 3u);
+}
+
+TEST_F(ReassemblerTest, Add_LargeIndexBeyondDenseTable_Completes) {
+    ShardedReassembler reassembler;
+    const uint32_t total = 70000;
+
+    // 倒序到达，并在稀疏区和稠密区各混入一个重复分片
+    for (uint32_t index = total; index >= 1; --index) {
+        EXPECT_TRUE(reassembler.add(makeBlock("big00001", index, total, std::string(1, char('a' + index % 26))),
+                                    total - index));
+        if (index == total || index == 2) {
+            reassembler.add(makeBlock("big00001", index, total, "?"), total);
+        }
+    }
+
+    auto completed = reassembler.takeCompleted();
+    ASSERT_EQ(completed.size(), 1u);
+    ASSERT_EQ(completed[0].data.size(), total);
+    EXPECT_EQ(completed[0].data[0], 'b');
+    EXPECT_EQ(completed[0].data[1], 'c');
+    EXPECT_EQ(completed[0].data[total - 1], 'a' + total % 26);
+    EXPECT_EQ(reassembler.stats().duplicateChunks, 2u);
+}
+
+TEST_F(ReassemblerTest, AddView_MatchesParsedBlocks) {
+    std::vector<uint8_t> data(100);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>(i * 3);
+    }
+    auto blocks = encoder.encode("image", data, 16);
+
+    ShardedReassembler reassembler;
+    std::vector<std::string> lines;
+    for (const auto& block : blocks) {
+        lines.push_back(toLogLine(block));
+    }
+    lines.push_back(lines[2]);   // 重复行不会被解码
+
+    for (size_t i = lines.size(); i-- > 0;) {
+        RichLogLineView view;
+        ASSERT_TRUE(scanRichLogLine(lines[i], view));
+        reassembler.add(view, i);
+    }
+
+    auto completed = reassembler.takeCompleted();
+    ASSERT_EQ(completed.size(), 1u);
+    EXPECT_EQ(completed[0].type, "image");
+    EXPECT_EQ(completed[0].uuid, blocks[0].uuid);
+    EXPECT_EQ(completed[0].data, data);
+    EXPECT_EQ(reassembler.stats().duplicateChunks, 1u);
+}
+
+TEST_F(ReassemblerTest, ShardOf_IsStableAndInRange) {
+    ReassemblerOptions options;
+    options.shardCount = 8;
+    ShardedReassembler reassembler(options);
+
+    EXPECT_EQ(reassembler.shardCount(), 8u);
+    EXPECT_EQ(reassembler.shardOf("abc123"), reassembler.shardOf("abc123"));
+    EXPECT_LT(reassembler.shardOf("def456"), 8u);
+}
+
+TEST_F(ReassemblerTest, AddLines_InterleavedPayloads_MatchSequentialOrder) {
+    // 构造多个交错的载荷，同一 uuid 的分片分散在文件各处
+    std::vector<std::vector<RichLogBlock>> payloads;
+    std::vector<std::vector<uint8_t>> originals;
+    for (int p = 0; p < 12; ++p) {
+        std::vector<uint8_t> data(static_cast<size_t>(20 + p * 13));
+        for (size_t i = 0; i < data.size(); ++i) {
+            data[i] = static_cast<uint8_t>(i * 7 + p);
+        }
+        originals.push_back(data);
+        payloads.push_back(encoder.encode(p % 2 ? "config" : "image", data, 8));
+    }
+
+    std::vector<std::string> lines;
+    bool remaining = true;
+    for (size_t round = 0; remaining; ++round) {
+        remaining = false;
+        for (const auto& blocks : payloads) {
+            if (round < blocks.size()) {
+                lines.push_back(toLogLine(blocks[round]));
+                lines.push_back("[2023-08-15 10:00:01.236] INFO: unrelated line");
+                remaining = true;
+            }
+        }
+    }
+
+    ReassemblerOptions sequentialOptions;
+    sequentialOptions.shardCount = 1;
+    ShardedReassembler sequential(sequentialOptions);
+    RichLogParser parser;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        auto block = parser.parse(lines[i]);
+        if (block) {
+            sequential.add(std::move(*block), i);
+        }
+    }
+    auto expected = sequential.takeCompleted();
+    ASSERT_EQ(expected.size(), payloads.size());
+
+    ThreadPool pool(4);
+    ReassemblerOptions parallelOptions;
+    parallelOptions.deterministicOrder = true;
+    ShardedReassembler parallel(parallelOptions);
+    parallel.addLines(pool, lines);
+    auto actual = parallel.takeCompleted();
+
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); ++i) {
+        EXPECT_EQ(actual[i].uuid, expected[i].uuid);
+        EXPECT_EQ(actual[i].type, expected[i].type);
+        EXPECT_EQ(actual[i].data, expected[i].data);
+        EXPECT_EQ(actual[i].sequence, expected[i].sequence);
+    }
+    EXPECT_EQ(parallel.pendingCount(), 0u);
+}
+
+TEST_F(ReassemblerTest, AddLines_LateDuplicatesAfterCompletion_MatchSequentialOrder) {
+    std::vector<std::string> lines;
+    for (uint32_t index = 1; index <= 3; ++index) {
+        for (int p = 0; p < 4; ++p) {
+            std::string text = "payload " + std::to_string(p) + " chunk " + std::to_string(index);
+            lines.push_back(toLogLine(makeBlock("late000" + std::to_string(p), index, 3, text)));
+        }
+    }
+    // 采集端重新投递了整段日志，其中一个分片内容已损坏
+    size_t firstPass = lines.size();
+    for (size_t i = 0; i < firstPass; ++i) {
+        lines.push_back(lines[i]);
+    }
+    lines[firstPass + 5] = toLogLine(makeBlock("late0001", 2, 3, "corrupted chunk"));
+
+    ReassemblerOptions sequentialOptions;
+    sequentialOptions.shardCount = 1;
+    ShardedReassembler sequential(sequentialOptions);
+    RichLogParser parser;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        sequential.add(std::move(*parser.parse(lines[i])), i);
+    }
+    auto expected = sequential.takeCompleted();
+    ASSERT_EQ(expected.size(), 4u);
+
+    // 重复副本在载荷完成之后才提交，结果与顺序扫描一致
+    ThreadPool pool(4);
+    ReassemblerOptions parallelOptions;
+    parallelOptions.deterministicOrder = true;
+    ShardedReassembler parallel(parallelOptions);
+    parallel.addLines(pool, std::vector<std::string>(lines.begin(), lines.begin() + firstPass));
+    parallel.addLines(pool, std::vector<std::string>(lines.begin() + firstPass, lines.end()), firstPass);
+    auto actual = parallel.takeCompleted();
+
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); ++i) {
+        EXPECT_EQ(actual[i].uuid, expected[i].uuid);
+        EXPECT_EQ(actual[i].data, expected[i].data);
+        EXPECT_EQ(actual[i].sequence, expected[i].sequence);
+    }
+    EXPECT_EQ(parallel.pendingCount(), 0u);
+    EXPECT_EQ(parallel.stats().duplicateChunks, firstPass);
+}
+
+TEST_F(ReassemblerTest, Add_ReferenceBlocks_ResolveInAnyOrder) {
+    std::vector<uint8_t> data(200, 0x5a);
+    encoder.setDeduplication(8);
+    auto original = encoder.encode("config", data, 64);
+    auto reference = encoder.encode("config", data, 64);
+    ASSERT_EQ(reference.size(), 1u);
+
+    ReassemblerOptions options;
+    options.deterministicOrder = true;
+    ShardedReassembler reassembler(options);
+
+    // 引用先于原始载荷到达（来自另一个扫描区间）
+    EXPECT_TRUE(reassembler.add(reference[0], 10));
+    EXPECT_EQ(reassembler.pendingCount(), 1u);
+    for (size_t i = 0; i < original.size(); ++i) {
+        reassembler.add(original[i], i);
+    }
+
+    auto completed = reassembler.takeCompleted();
+    ASSERT_EQ(completed.size(), 2u);
+    EXPECT_EQ(completed[0].uuid, original[0].uuid);
+    EXPECT_EQ(completed[1].uuid, reference[0].uuid);
+    EXPECT_EQ(completed[1].data, data);
+    EXPECT_EQ(completed[1].sequence, 10u);
+    EXPECT_EQ(reassembler.pendingCount(), 0u);
+
+    // 之后的引用直接从最近载荷缓存解析
+    reassembler.add(encoder.encode("config", data, 64)[0], 20);
+    completed = reassembler.takeCompleted();
+    ASSERT_EQ(completed.size(), 1u);
+    EXPECT_EQ(completed[0].data, data);
+}
+
+TEST_F(ReassemblerTest, Add_ReferenceBeyondCache_CountedUnresolved) {
+    ReassemblerOptions options;
+    options.referenceCacheSize = 1;
+    ShardedReassembler reassembler(options);
+
+    reassembler.add(makeBlock("aaaa0001", 1, 1, "first payload, 24 bytes"), 0);
+    reassembler.add(makeBlock("aaaa0002", 1, 1, "second payload, 24 bytes"), 1);
+    reassembler.takeCompleted();
+
+    // 被引用载荷已完成但被挤出缓存，不会再出现，引用不必一直等待
+    RichLogBlock reference("test", "bbbb0001", 0, 0);
+    reference.data = {0xaa, 0xaa, 0x00, 0x01};
+    EXPECT_FALSE(reassembler.add(reference, 2));
+
+    EXPECT_TRUE(reassembler.takeCompleted().empty());
+    EXPECT_EQ(reassembler.pendingCount(), 0u);
+    EXPECT_EQ(reassembler.stats().unresolvedReferences, 1u);
+}
+
+TEST_F(ReassemblerTest, Add_ReferenceToSmallOrDroppedPayload_CountedUnresolved) {
+    ReassemblerOptions options;
+    options.duplicatePolicy = DuplicatePolicy::VerifyChecksum;
+    ShardedReassembler reassembler(options);
+
+    // 小于 kMinDedupSize 的载荷写入端不会去重，读取端也不缓存
+    reassembler.add(makeBlock("aaaa0001", 1, 1, "tiny"), 0);
+    RichLogBlock toSmall("test", "bbbb0001", 0, 0);
+    toSmall.data = {0xaa, 0xaa, 0x00, 0x01};
+    EXPECT_FALSE(reassembler.add(toSmall, 1));
+
+    // 等待中的引用在被引用载荷因冲突丢弃时放弃
+    RichLogBlock toDropped("test", "bbbb0002", 0, 0);
+    toDropped.data = {0xaa, 0xaa, 0x00, 0x02};
+    EXPECT_TRUE(reassembler.add(toDropped, 2));
+    reassembler.add(makeBlock("aaaa0002", 1, 2, "AB"), 3);
+    reassembler.add(makeBlock("aaaa0002", 1, 2, "XY"), 4);
+    reassembler.add(makeBlock("aaaa0002", 2, 2, "CD"), 5);
+
+    auto completed = reassembler.takeCompleted();
+    ASSERT_EQ(completed.size(), 1u);
+    EXPECT_EQ(completed[0].uuid, "aaaa0001");
+    EXPECT_EQ(reassembler.pendingCount(), 0u);
+    EXPECT_EQ(reassembler.stats().droppedPayloads, 1u);
+    EXPECT_EQ(reassembler.stats().unresolvedReferences, 2u);
+}
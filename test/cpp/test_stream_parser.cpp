@@ -0,0 +1,315 @@
+#include <gtest/gtest.h>
+#include "stream_parser.hpp"
+#include "richlog_wasm.h"
+#include "scanner.hpp"
+#include "test_helpers.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace richlog;
+
+class StreamParserTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        for (size_t i = 0; i < 300; ++i) {
+            data.push_back(static_cast<uint8_t>(i * 13));
+        }
+        RichLogEncoder encoder;
+        auto blocks = encoder.encode("image", data, 50);
+        uuid = blocks[0].uuid;
+
+        content = "[2023-08-15 10:00:01.236] INFO: start\r\n\n";
+        for (const auto& block : blocks) {
+            content += toLogLine(block) + "\r\n";
+            content += "[2023-08-15 10:00:01.237] DEBUG: between chunks\n";
+        }
+        content += "[2023-08-15 10:00:01.238] INFO: no trailing newline";
+    }
+
+    std::vector<uint8_t> data;
+    std::string uuid;
+    std::string content;
+};
+
+TEST_F(StreamParserTest, Feed_ArbitrarySplits_ReassemblesPayload) {
+    for (size_t step : {1u, 7u, 64u, 4096u}) {
+        StreamParser parser;
+        for (size_t offset = 0; offset < content.size(); offset += step) {
+            parser.feed(content.data() + offset, std::min(step, content.size() - offset));
+        }
+        EXPECT_LT(parser.bytesConsumed(), content.size());
+        parser.finish();
+
+        auto completed = parser.takeCompleted();
+        ASSERT_EQ(completed.size(), 1u) << step;
+        EXPECT_EQ(completed[0].uuid, uuid);
+        EXPECT_EQ(completed[0].data, data);
+        EXPECT_EQ(completed[0].sequence, 12u);   // 第 6 个分片位于第 12 行（从 0 开始）
+        EXPECT_EQ(parser.linesProcessed(), 15u);
+        EXPECT_EQ(parser.bytesConsumed(), content.size());
+    }
+}
+
+TEST_F(StreamParserTest, Feed_DuplicatedLinesAfterCompletion_EmittedOnce) {
+    // at-least-once 采集把整段日志投递了两次
+    std::string twice = content + "\n" + content + "\n";
+    StreamParser parser;
+    parser.feed(twice.data(), twice.size());
+
+    auto completed = parser.takeCompleted();
+    ASSERT_EQ(completed.size(), 1u);
+    EXPECT_EQ(completed[0].data, data);
+    EXPECT_EQ(parser.pendingCount(), 0u);
+    EXPECT_TRUE(parser.checkpoint().pending.empty());
+}
+
+TEST_F(StreamParserTest, CApi_StreamsPayloads) {
+    richlog_stream* stream = richlog_stream_create();
+
+    size_t half = content.size() / 2;
+    uint8_t* buffer = richlog_stream_buffer(stream, half);
+    std::memcpy(buffer, content.data(), half);
+    richlog_stream_feed(stream, half);
+    EXPECT_EQ(richlog_stream_poll(stream), 0u);
+
+    size_t rest = content.size() - half;
+    buffer = richlog_stream_buffer(stream, rest);
+    std::memcpy(buffer, content.data() + half, rest);
+    richlog_stream_feed(stream, rest);
+    richlog_stream_finish(stream);
+
+    ASSERT_EQ(richlog_stream_poll(stream), 1u);
+    EXPECT_STREQ(richlog_payload_type(stream, 0), "image");
+    EXPECT_EQ(std::string(richlog_payload_uuid(stream, 0)), uuid);
+    ASSERT_EQ(richlog_payload_size(stream, 0), data.size());
+    EXPECT_EQ(std::memcmp(richlog_payload_data(stream, 0), data.data(), data.size()), 0);
+    EXPECT_EQ(richlog_payload_line(stream, 0), 12.0);
+    EXPECT_EQ(richlog_payload_type(stream, 1), nullptr);
+
+    EXPECT_EQ(richlog_stream_poll(stream), 0u);
+    richlog_stream_destroy(stream);
+}
+
+namespace {
+
+std::vector<std::string> describe(const std::vector<ReassembledPayload>& payloads) {
+    std::vector<std::string> result;
+    for (const auto& payload : payloads) {
+        std::string text = payload.type + "/" + payload.uuid + "@" + std::to_string(payload.sequence) + ":";
+        appendHex(text, payload.data.data(), payload.data.size());
+        result.push_back(text);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+} // namespace
+
+class StreamCheckpointTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        RichLogEncoder encoder;
+        encoder.setDeduplication(16);
+        std::vector<uint8_t> image(300), config(120), command(80);
+        for (size_t i = 0; i < image.size(); ++i) {
+            image[i] = static_cast<uint8_t>(i * 7);
+        }
+        for (size_t i = 0; i < config.size(); ++i) {
+            config[i] = static_cast<uint8_t>(i + 1);
+        }
+        for (size_t i = 0; i < command.size(); ++i) {
+            command[i] = static_cast<uint8_t>(255 - i);
+        }
+
+        auto imageBlocks = encoder.encode("image", image, 50);
+        auto configBlocks = encoder.encode("config", config, 50);
+        // 两个载荷的分片交错出现
+        for (size_t i = 0; i < imageBlocks.size(); ++i) {
+            content += "[2023-08-15 10:00:01.236] INFO: line " + std::to_string(i) + "\n";
+            content += toLogLine(imageBlocks[i]) + "\n";
+            if (i < configBlocks.size()) {
+                content += toLogLine(configBlocks[i]) + "\n";
+            }
+        }
+        content += "[2023-08-15 10:00:01.237] DEBUG: references follow\r\n";
+        content += toLogLine(encoder.encode("image", image, 50)[0]) + "\n";     // 引用已完成的 image
+        auto commandBlocks = encoder.encode("command", command, 30);
+        content += toLogLine(commandBlocks[1]) + "\n";
+        content += toLogLine(encoder.encode("command", command, 30)[0]) + "\n"; // 引用尚未完成的 command
+        content += toLogLine(commandBlocks[0]) + "\n";
+        content += toLogLine(commandBlocks[0]) + "\n";                          // 重复分片
+        content += toLogLine(commandBlocks[2]) + "\n";
+        content += toLogLine(encoder.encode("config", config, 50)[0]) + "\n";   // 引用 config
+        content += "[2023-08-15 10:00:01.238] INFO: done";
+
+        StreamParser parser;
+        parser.feed(content.data(), content.size());
+        parser.finish();
+        expected = describe(parser.takeCompleted());
+    }
+
+    std::string content;
+    std::vector<std::string> expected;
+};
+
+TEST_F(StreamCheckpointTest, Restore_AnyCutPosition_NoDuplicateOrLostPayloads) {
+    ASSERT_EQ(expected.size(), 6u);
+
+    for (size_t cut = 0; cut <= content.size(); cut += 5) {
+        StreamParser first;
+        first.feed(content.data(), cut);
+        auto payloads = first.takeCompleted();
+
+        StreamCheckpoint checkpoint;
+        ASSERT_TRUE(StreamCheckpoint::parse(first.checkpoint().serialize(), checkpoint)) << cut;
+        EXPECT_LE(checkpoint.offset, cut);
+
+        std::istringstream input(content);
+        StreamParser second;
+        ASSERT_TRUE(second.restore(checkpoint, input)) << cut;
+        second.feed(content.data() + checkpoint.offset, content.size() - checkpoint.offset);
+        second.finish();
+        for (auto& payload : second.takeCompleted()) {
+            payloads.push_back(std::move(payload));
+        }
+
+        EXPECT_EQ(describe(payloads), expected) << cut;
+        EXPECT_EQ(second.linesProcessed(), 24u);
+        EXPECT_EQ(second.pendingCount(), 0u);
+    }
+}
+
+TEST_F(StreamCheckpointTest, Checkpoint_DroppedPayload_NotPending) {
+    ReassemblerOptions options;
+    options.duplicatePolicy = DuplicatePolicy::VerifyChecksum;
+    StreamParser parser(options);
+
+    std::string text = "RICHLOG:image,5f35c0af,1,2,0102\n"
+                       "RICHLOG:config,1a2b3c4d,0,0,5f35c0af\n"   // 等待 image 的引用
+                       "RICHLOG:image,5f35c0af,1,2,0a0b\n"        // 内容冲突的重复分片
+                       "RICHLOG:image,5f35c0af,2,2,0304\n"
+                       "RICHLOG:command,77aa88bb,1,2,46\n";
+    parser.feed(text.data(), text.size());
+
+    EXPECT_TRUE(parser.takeCompleted().empty());
+    EXPECT_EQ(parser.pendingCount(), 1u);
+    auto checkpoint = parser.checkpoint();
+    ASSERT_EQ(checkpoint.pending.size(), 1u);
+    EXPECT_EQ(checkpoint.pending[0].uuid, "77aa88bb");
+}
+
+TEST_F(StreamCheckpointTest, Restore_DuplicateOfFinishedSmallPayload_NotReEmitted) {
+    // 小载荷不进入最近完成列表，只能靠检查点中的已结束 uuid 识别迟到的重复分片
+    std::string text = "RICHLOG:command,77aa88bb,1,1,46\n"
+                       "RICHLOG:image,5f35c0af,1,2,0102\n"
+                       "RICHLOG:image,5f35c0af,2,2,0304\n"
+                       "[2023-08-15 10:00:01.236] INFO: restart here\n";
+    std::string replayed = "RICHLOG:command,77aa88bb,1,1,46\n"
+                           "RICHLOG:image,5f35c0af,2,2,0304\n";
+
+    StreamParser first;
+    first.feed(text.data(), text.size());
+    ASSERT_EQ(first.takeCompleted().size(), 2u);
+
+    StreamCheckpoint checkpoint;
+    ASSERT_TRUE(StreamCheckpoint::parse(first.checkpoint().serialize(), checkpoint));
+    EXPECT_EQ(checkpoint.finished.size(), 2u);
+    EXPECT_TRUE(checkpoint.recent.empty());
+
+    std::string content = text + replayed;
+    std::istringstream input(content);
+    StreamParser second;
+    ASSERT_TRUE(second.restore(checkpoint, input));
+    second.feed(content.data() + checkpoint.offset, content.size() - checkpoint.offset);
+
+    EXPECT_TRUE(second.takeCompleted().empty());
+    EXPECT_EQ(second.pendingCount(), 0u);
+    EXPECT_TRUE(second.checkpoint().pending.empty());
+}
+
+TEST_F(StreamCheckpointTest, Checkpoint_StalePendingEntries_Expired) {
+    StreamParser parser(ReassemblerOptions(), 4);
+    std::string text = "RICHLOG:image,5f35c0af,1,2,0102\n"        // 截断的载荷
+                       "RICHLOG:config,1a2b3c4d,0,0,deadbeef\n";  // 被引用载荷始终没有出现
+    for (int i = 0; i < 3; ++i) {
+        text += "[2023-08-15 10:00:01.236] INFO: line " + std::to_string(i) + "\n";
+    }
+    text += "RICHLOG:command,77aa88bb,1,2,46\n";
+    parser.feed(text.data(), text.size());
+
+    // 第 0 行的载荷距第 5 行超过 4 行已过期，第 1 行的引用刚好在跨度内
+    auto checkpoint = parser.checkpoint();
+    ASSERT_EQ(checkpoint.pending.size(), 2u);
+    EXPECT_EQ(checkpoint.pending[0].uuid, "1a2b3c4d");
+    EXPECT_EQ(checkpoint.pending[1].uuid, "77aa88bb");
+
+    std::string more = "[2023-08-15 10:00:01.236] INFO: line 3\n"
+                       "RICHLOG:image,5f35c0af,2,2,0304\n";       // 过期载荷迟到的分片
+    parser.feed(more.data(), more.size());
+
+    EXPECT_TRUE(parser.takeCompleted().empty());
+    checkpoint = parser.checkpoint();
+    ASSERT_EQ(checkpoint.pending.size(), 1u);
+    EXPECT_EQ(checkpoint.pending[0].uuid, "77aa88bb");
+    EXPECT_EQ(parser.pendingCount(), 1u);
+}
+
+TEST_F(StreamCheckpointTest, Checkpoint_UntakenPayloads_ReplayedAfterRestore) {
+    StreamParser first;
+    first.feed(content.data(), content.size());
+    auto checkpoint = first.checkpoint();    // 未调用 takeCompleted
+    EXPECT_EQ(checkpoint.pending.size(), 6u);
+    EXPECT_TRUE(checkpoint.recent.empty());
+
+    std::istringstream input(content);
+    StreamParser second;
+    ASSERT_TRUE(second.restore(checkpoint, input));
+    second.finish();
+    EXPECT_EQ(describe(second.takeCompleted()), expected);
+
+    // 取走之后只剩最近完成的载荷，没有待重放的分片
+    auto after = second.checkpoint();
+    EXPECT_TRUE(after.pending.empty());
+    EXPECT_EQ(after.recent.size(), 3u);
+}
+
+TEST_F(StreamCheckpointTest, SaveLoad_RoundTrip) {
+    StreamParser parser;
+    parser.feed(content.data(), content.size() / 2);
+    parser.takeCompleted();
+    auto checkpoint = parser.checkpoint();
+    checkpoint.pending.push_back(StreamCheckpoint::Entry{"uuid with space", {{1, 2}}});
+
+    std::string path = ::testing::TempDir() + "richlog_checkpoint_test.txt";
+    ASSERT_TRUE(checkpoint.save(path));
+    StreamCheckpoint loaded;
+    ASSERT_TRUE(StreamCheckpoint::load(path, loaded));
+    std::remove(path.c_str());
+    EXPECT_EQ(loaded.serialize(), checkpoint.serialize());
+    EXPECT_EQ(loaded.pending.back().uuid, "uuid with space");
+}
+
+TEST_F(StreamCheckpointTest, Parse_Malformed_ReturnsFalse) {
+    StreamCheckpoint checkpoint;
+    EXPECT_FALSE(StreamCheckpoint::parse("", checkpoint));
+    EXPECT_FALSE(StreamCheckpoint::parse("richlog-checkpoint 2\nposition 0 0\nend\n", checkpoint));
+    EXPECT_FALSE(StreamCheckpoint::parse("richlog-checkpoint 1\nposition 10 2\n", checkpoint));
+    EXPECT_FALSE(StreamCheckpoint::parse("richlog-checkpoint 1\nposition x 2\nend\n", checkpoint));
+    EXPECT_FALSE(StreamCheckpoint::parse("richlog-checkpoint 1\nposition 10 2\npending 2 1:0 ab\nend\n", checkpoint));
+    EXPECT_TRUE(StreamCheckpoint::parse("richlog-checkpoint 1\nposition 10 2\npending 1 1:0 ab\nend\n", checkpoint));
+    EXPECT_EQ(checkpoint.pending[0].uuid, "ab");
+}
+
+TEST_F(StreamCheckpointTest, Restore_FileShorterThanCheckpoint_ReturnsFalse) {
+    StreamParser first;
+    first.feed(content.data(), content.size());
+    auto checkpoint = first.checkpoint();
+
+    std::istringstream truncated(content.substr(0, content.size() / 2));
+    StreamParser second;
+    EXPECT_FALSE(second.restore(checkpoint, truncated));
+}
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include "thread_pool.hpp"
+#include "richlog.hpp"
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+using namespace richlog;
+
+class ThreadPoolTest : public ::testing::Test {
+protected:
+    ThreadPool pool{4};
+};
+
+TEST_F(ThreadPoolTest, Submit_ReturnsTaskResult) {
+    auto future = pool.submit([]() { return 6 * 7; });
+    EXPECT_EQ(future.get(), 42);
+}
+
+TEST_F(ThreadPoolTest, Submit_ExceptionPropagatesThroughFuture) {
+    auto future = pool.submit([]() -> int { throw std::runtime_error("boom"); });
+    EXPECT_THROW(future.get(), std::runtime_error);
+}
+
+TEST_F(ThreadPoolTest, Size_DefaultUsesAtLeastOneThread) {
+    ThreadPool defaultPool;
+    EXPECT_GE(defaultPool.size(), 1u);
+    EXPECT_EQ(pool.size(), 4u);
+}
+
+TEST_F(ThreadPoolTest, ParallelFor_VisitsEveryIndexOnce) {
+    std::vector<std::atomic<int>> hits(10000);
+    pool.parallelFor(0, hits.size(), 64, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            hits[i].fetch_add(1);
+        }
+    });
+
+    for (const auto& hit : hits) {
+        EXPECT_EQ(hit.load(), 1);
+    }
+}
+
+TEST_F(ThreadPoolTest, ParallelFor_EmptyRange_DoesNothing) {
+    bool called = false;
+    pool.parallelFor(5, 5, 0, [&](size_t, size_t) { called = true; });
+    EXPECT_FALSE(called);
+}
+
+TEST_F(ThreadPoolTest, ParallelFor_RethrowsBodyException) {
+    EXPECT_THROW(pool.parallelFor(0, 100, 10, [](size_t begin, size_t) {
+        if (begin == 50) {
+            throw std::runtime_error("chunk failed");
+        }
+    }), std::runtime_error);
+}
+
+TEST_F(ThreadPoolTest, ParallelFor_NestedInsideTask_DoesNotDeadlock) {
+    std::vector<std::future<size_t>> futures;
+    for (int t = 0; t < 8; ++t) {
+        futures.push_back(pool.submit([this]() {
+            std::atomic<size_t> sum{0};
+            pool.parallelFor(0, 1000, 10, [&](size_t begin, size_t end) {
+                size_t local = 0;
+                for (size_t i = begin; i < end; ++i) {
+                    local += i;
+                }
+                sum.fetch_add(local);
+            });
+            return sum.load();
+        }));
+    }
+
+    for (auto& future : futures) {
+        EXPECT_EQ(future.get(), 999u * 1000u / 2u);
+    }
+}
+
+TEST_F(ThreadPoolTest, Post_FromBlockedWorker_TasksAreStolen) {
+    // 任务进入当前工作线程的队列后该线程阻塞等待，只有被其他线程窃取才能完成
+    auto outer = pool.submit([this]() {
+        std::vector<std::future<int>> inner;
+        for (int i = 0; i < 16; ++i) {
+            inner.push_back(pool.submit([i]() { return i; }));
+        }
+        int sum = 0;
+        for (auto& future : inner) {
+            sum += future.get();
+        }
+        return sum;
+    });
+
+    EXPECT_EQ(outer.get(), 120);
+}
+
+TEST_F(ThreadPoolTest, WaitIdle_WaitsForAllPostedTasks) {
+    std::atomic<int> counter{0};
+    for (int i = 0; i < 1000; ++i) {
+        pool.post([&counter]() { counter.fetch_add(1); });
+    }
+    pool.waitIdle();
+    EXPECT_EQ(counter.load(), 1000);
+}
+
+TEST_F(ThreadPoolTest, CurrentWorkerIndex_OnlyInsideWorkers) {
+    EXPECT_EQ(pool.currentWorkerIndex(), ThreadPool::npos);
+    auto index = pool.submit([this]() { return pool.currentWorkerIndex(); }).get();
+    EXPECT_LT(index, pool.size());
+}
+
+TEST_F(ThreadPoolTest, CpuAffinity_PinnedPoolRunsTasks) {
+    ThreadPoolOptions options;
+    options.threadCount = 2;
+    options.cpuAffinity = {0};
+    ThreadPool pinned(options);
+
+    EXPECT_EQ(pinned.submit([]() { return 1; }).get(), 1);
+}
+
+TEST_F(ThreadPoolTest, ParallelDecode_MatchesSequentialDecode) {
+    RichLogEncoder encoder;
+    std::vector<std::vector<RichLogBlock>> payloads;
+    std::vector<std::vector<uint8_t>> originals;
+    for (int p = 0; p < 32; ++p) {
+        // 大小差异很大的载荷，模拟大图片与小配置混合
+        std::vector<uint8_t> data(static_cast<size_t>(p % 4 == 0 ? 20000 : 30 + p));
+        std::iota(data.begin(), data.end(), static_cast<uint8_t>(p));
+        originals.push_back(data);
+        payloads.push_back(encoder.encode("test", data, 100));
+    }
+
+    std::vector<std::vector<uint8_t>> decoded(payloads.size());
+    pool.parallelFor(0, payloads.size(), 1, [&](size_t begin, size_t end) {
+        RichLogDecoder decoder;
+        for (size_t i = begin; i < end; ++i) {
+            decoded[i] = decoder.decode(payloads[i]);
+        }
+    });
+
+    EXPECT_EQ(decoded, originals);
+}
@@ -0,0 +1,73 @@
+/**
+ * RichLog 解析器跨语言一致性检查
+ * 用 JS 解析器解析 parser_diff 写出的语料，与 C++ 参考实现的结果逐行比较
+ *
+ * 用法: node parser-parity.js <corpus.log> <expected.jsonl>
+ */
+
+const fs = require('fs');
+const RichLogParser = require('../../src/core/parser');
+
+// 按 '\n' 切分，文件末尾的换行不产生空行
+function readLines(file) {
+  // latin1 使每个字节对应一个字符，与 C++ 按字节匹配的语义一致
+  const lines = fs.readFileSync(file, 'latin1').split('\n');
+  if (lines.length > 0 && lines[lines.length - 1] === '') {
+    lines.pop();
+  }
+  return lines;
+}
+
+// 转换为与 C++ describeParseResult 相同的字段；C++ 忽略末尾落单的十六进制字符
+function describe(result) {
+  if (!result) return null;
+  const evenLength = result.hexData.length & ~1;
+  return {
+    type: result.type,
+    uuid: result.uuid,
+    index: result.index,
+    total: result.totalChunks,
+    data: result.hexData.slice(0, evenLength).toLowerCase()
+  };
+}
+
+function main() {
+  const [corpusFile, expectedFile] = process.argv.slice(2);
+  if (!corpusFile || !expectedFile) {
+    console.error('用法: node parser-parity.js <corpus.log> <expected.jsonl>');
+    process.exit(2);
+  }
+
+  const lines = readLines(corpusFile);
+  const expected = readLines(expectedFile).map(line => JSON.parse(line));
+  if (lines.length !== expected.length) {
+    console.error(`❌ 行数不一致: 语料 ${lines.length} 行，结果 ${expected.length} 行`);
+    process.exit(2);
+  }
+
+  const parser = new RichLogParser();
+  const start = process.hrtime.bigint();
+  const actual = lines.map(line => describe(parser.parseLine(line)));
+  const seconds = Number(process.hrtime.bigint() - start) / 1e9;
+
+  let mismatches = 0;
+  actual.forEach((result, i) => {
+    const a = JSON.stringify(result);
+    const b = JSON.stringify(expected[i]);
+    if (a === b) return;
+    if (++mismatches <= 20) {
+      console.log(`\n第 ${i + 1} 行: ${JSON.stringify(lines[i])}`);
+      console.log(`  cpp  ${b}`);
+      console.log(`  js   ${a}`);
+    }
+  });
+
+  console.log(`📊 ${lines.length} 行，JS 解析耗时 ${(seconds * 1000).toFixed(1)} ms`);
+  if (mismatches > 0) {
+    console.log(`❌ ${mismatches} 行与 C++ 结果不一致`);
+    process.exit(1);
+  }
+  console.log('✅ JS 与 C++ 结果一致');
+}
+
+main();
@@ -86,10 +86,18 @@ module.exports = {
       'window.RICHLOG_PLUGIN_TYPES': JSON.stringify(availablePlugins)
     }),
     new CopyWebpackPlugin({
-      patterns: availablePlugins.map(type => ({
-        from: `./src/plugins/${type}/plugin.json`,
-        to: `plugins/${type}/plugin.json`
-      })),
+      patterns: [
+        ...availablePlugins.map(type => ({
+          from: `./src/plugins/${type}/plugin.json`,
+          to: `plugins/${type}/plugin.json`
+        })),
+        // npm run build:wasm 的输出，未构建时跳过
+        {
+          from: 'build-wasm/richlog_wasm.{js,wasm}',
+          to: 'wasm/[name][ext]',
+          noErrorOnMissing: true
+        }
+      ],
     }),
     new HtmlWebpackPlugin({
       template: './src/web/index.html',